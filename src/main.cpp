@@ -15,13 +15,23 @@
 //   PLATFORM,x,y,w,h
 //   SPIKE,x,y,w,h
 //   JUMP_PAD,x,y,w,h[,power]
+// level.txt may instead hold a level string copied from GD (the encoded "H4sI..." data);
+// the common blocks, spikes and pads in it are read, on top of GD's floor.
+// level.pfl in the same place is read instead when present: the binary form written by
+// `pathfinder-cli convert`. Every live extraction is also saved as live.pfs, a snapshot of
+// the GD objects read that every pathfinder-cli command accepts as a level.
 //
 // Output:
-//   macro.txt   - newline-separated frame numbers to press jump
+//   macro.txt   - one jump press per line: "frame" for a tap, "press release" for a hold
+//                 (button down from press up to, not including, release)
 //   pathfinder_report.txt - human-readable debug info
 //
 // Tune physics constants below to match your GD version if needed.
+//
+// Building with -DPATHFINDER_HEADLESS=ON (CMake) drops the Geode parts and produces a
+// command-line tool for offline solving and benchmarking; see main() at the bottom.
 
+#ifndef PATHFINDER_HEADLESS
 #include <Geode/Bindings.hpp>
 #include <Geode/modify/MenuLayer.hpp>
 #include <Geode/binding/FLAlertLayer.hpp>
@@ -30,16 +40,56 @@
 #include <Geode/ui/Notification.hpp>
 #include <Geode/utils/Log.hpp>
 #include <Geode/loader/Dirs.hpp>
+#include <Geode/loader/Loader.hpp>
+#endif
 
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cmath>
 #include <filesystem>
 #include <iomanip>
+#include <array>
+#include <charconv>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <random>
+#include <set>
+#include <unordered_map>
+#include <thread>
+#include <tuple>
+#include <iostream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#if defined(__linux__) && defined(PATHFINDER_HEADLESS) && __has_include(<linux/io_uring.h>)
+#define PATHFINDER_IO_URING
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#endif
 
+#ifndef PATHFINDER_HEADLESS
 using namespace geode::prelude;
+#endif
 
 static constexpr float FRAME_DT = 1.0f / 60.0f;   // 60 FPS
 static constexpr float PLAYER_SPEED = 220.0f;     // px/s
@@ -47,7 +97,44 @@ static constexpr float GRAVITY = -1600.0f;        // px/s^2
 static constexpr float JUMP_VELOCITY = 680.0f;    // px/s
 static constexpr float START_BEFORE_X = 16.0f;
 static constexpr int LOOKAHEAD = 36;
+static constexpr int HORIZON_MIN = 8;             // adaptive lookahead bounds, frames
+static constexpr int HORIZON_EMPTY = 12;          // horizon when nothing lies ahead
+static constexpr int HORIZON_MAX = 180;
+static constexpr float SIGNATURE_GRID = 8.0f;     // px quantum of obstacle signatures
+static constexpr size_t MEMO_GENERATION = 1 << 15; // probe memo entries per shard generation
+static constexpr float SHORT_OBJ_W = 256.0f;      // wider objects are scanned separately in window queries
+static constexpr float PATTERN_LEAD = 200.0f;     // px before a hazard where its takeoffs may lie
+static constexpr float PATTERN_SPAN = 400.0f;     // px past a hazard covered by one library pattern
+static constexpr int PATTERN_MAX_JUMPS = 6;
 static constexpr int MAX_FRAMES = 60 * 300;
+static constexpr int MAX_DELAY = 8;               // furthest delayed jump tried at a decision
+static constexpr int BT_RING = 1024;              // decision points kept for rollback, grounded coasting frames included
+static constexpr int BT_MAX_BACKTRACKS = 20000;
+static constexpr int CHECK_LEVELS = 30;           // generated levels `pathfinder-cli check` runs with none given
+static constexpr float SEAM_MIN_SEGMENT = 600.0f;  // px between segment-parallel seams
+static constexpr int LATTICE_SUBDIV = 2;           // vy rows per frame of gravity
+static constexpr int NOGOOD_BLOOM_BITS = 1 << 20;
+static constexpr int INFLATE_FAST_BITS = 10;      // Huffman codes decoded with one table lookup
+static constexpr size_t INFLATE_CHUNK = 1u << 20; // bytes a streaming inflate hands on at a time
+static constexpr size_t SAVE_CHUNK = 1u << 20;    // save file bytes decoded at a time
+static constexpr size_t PACK_SHAPES = 127;        // trained shape table entries; indices stay one byte
+static constexpr size_t IMPORT_QUEUE = 4;         // decoded levels waiting per import or batch worker
+static constexpr unsigned IO_DEPTH = 64;          // file reads and writes kept in flight by the batch loader
+static constexpr int IO_POOL_THREADS = 8;         // blocking I/O threads when there is no io_uring
+static constexpr size_t PARSE_CHUNK_MIN = 1u << 20;  // level text per parser thread, at least
+static constexpr size_t PARSE_BENCH_BYTES = 256u << 20;  // text pushed through the parser by `parse`
+static constexpr float STREAM_AHEAD = 2048.0f;    // px of level read per streaming window
+static constexpr float STREAM_MARGIN = 1024.0f;   // px of a window's plan left uncommitted; beyond any probe
+static constexpr int COARSE_STEP = 4;             // frames per decision in the coarse pass; jumps then move at most this far
+static constexpr int REFINE_BACK = 60;            // frames replanned at full resolution before a coarse failure
+static constexpr int REFINE_AHEAD = 60;           // ... and after it
+static constexpr int SPEC_AHEAD = 64;             // frames of jump paths stepped ahead of the committed state
+static constexpr int SPEC_RING = 256;             // jump path slots; more than SPEC_AHEAD + HORIZON_MAX apart
+static constexpr int SPEC_EPOCH = 4096;           // coasting states kept before the speculator rebases
+static constexpr int SPEC_MAX_WORKERS = 4;
+static constexpr std::chrono::milliseconds ANYTIME_FIRST_ANSWER{100};
+static constexpr std::chrono::milliseconds ANYTIME_FIRST_STAGE{30};   // greedy's share of it; verifying and pressing its prefix steps each frame twice more
+static constexpr std::chrono::milliseconds ANYTIME_BUDGET{15000};
 
 struct Rect { float x, y, w, h; bool contains(float px, float py) const {
     return px >= x && px <= x + w && py >= y && py <= y + h;
@@ -67,7 +154,12 @@ struct SimState {
     bool onGround;
 };
 
+static thread_local unsigned long long stepCalls = 0;   // per-thread stepSim counter for benchmarks
+
+// One frame of physics. doJump is whether the jump button is down on this frame; it takes
+// off only from the ground, so a button held across a landing jumps again (see Hold).
 static SimState stepSim(const SimState& s, bool doJump, const std::vector<Obj>& objs) {
+    ++stepCalls;
     SimState n = s;
     if (doJump && n.onGround) {
         n.vy = JUMP_VELOCITY;
@@ -115,276 +207,4869 @@ static SimState stepSim(const SimState& s, bool doJump, const std::vector<Obj>&
     return n;
 }
 
-static bool runPathfinder(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report) {
+static constexpr float KILL_Y = -1000.0f;         // the player dies below this height
+static bool isDead(const SimState& s) { return s.py < KILL_Y; }
+
+// Cooperative stop signal for a running solve: cancelled by the owner or past its
+// deadline. Solvers poll it once per frame or decision and give up with a partial result.
+struct SolveControl {
+    std::atomic<bool> cancelled{false};
+    int speculativeWorkers = 0;   // greedy jump-path threads; opt in only where no pool already uses the cores
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    bool stopped() const {
+        return cancelled.load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= deadline;
+    }
+};
+
+// States proven to die while coasting, keyed on the frame plus the exact float bits of
+// (py, vy, onGround) - px is fixed by the frame within one solve. Stepping is
+// deterministic, so a probe that reaches a stored state dies at the stored frame too.
+// A Bloom filter in front keeps the common miss to two bit tests.
+struct NogoodCache {
+    struct Entry { uint32_t key[3]; int32_t deathFrame; };
+    std::vector<uint64_t> bloom = std::vector<uint64_t>(NOGOOD_BLOOM_BITS / 64);
+    std::vector<Entry> table = std::vector<Entry>(1024, Entry{{0, 0, 0}, -1});
+    size_t used = 0;
+    long long lookups = 0, hits = 0;
+    std::vector<SimState> scratch;
+
+    static void makeKey(const SimState& s, int frame, uint32_t key[3]) {
+        std::memcpy(&key[1], &s.py, 4);
+        std::memcpy(&key[2], &s.vy, 4);
+        key[0] = (uint32_t)frame | (s.onGround ? 0x80000000u : 0u);
+    }
+    static uint64_t hashKey(const uint32_t key[3]) {
+        uint64_t h = ((uint64_t)key[0] << 32 | key[1]) * 0x9E3779B97F4A7C15ull;
+        h ^= (h >> 29) + key[2] * 0xBF58476D1CE4E5B9ull;
+        return h ^ (h >> 32);
+    }
+    bool bloomTest(uint64_t h) const {
+        uint32_t a = h % NOGOOD_BLOOM_BITS, b = (h >> 32) % NOGOOD_BLOOM_BITS;
+        return (bloom[a / 64] >> (a % 64) & 1) && (bloom[b / 64] >> (b % 64) & 1);
+    }
+    Entry* slot(const uint32_t key[3], uint64_t h) {
+        size_t mask = table.size() - 1;
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            Entry& e = table[i];
+            if (e.deathFrame < 0 || std::memcmp(e.key, key, sizeof(e.key)) == 0) return &e;
+        }
+    }
+    // frame at which coasting from s (at `frame`) is known to die, or -1
+    int deathFrame(const SimState& s, int frame) {
+        ++lookups;
+        uint32_t key[3]; makeKey(s, frame, key);
+        uint64_t h = hashKey(key);
+        if (!bloomTest(h)) return -1;
+        Entry* e = slot(key, h);
+        if (e->deathFrame >= 0) ++hits;
+        return e->deathFrame;
+    }
+    void add(const SimState& s, int frame, int death) {
+        if ((used + 1) * 2 > table.size()) grow();
+        uint32_t key[3]; makeKey(s, frame, key);
+        uint64_t h = hashKey(key);
+        uint32_t a = h % NOGOOD_BLOOM_BITS, b = (h >> 32) % NOGOOD_BLOOM_BITS;
+        bloom[a / 64] |= 1ull << (a % 64);
+        bloom[b / 64] |= 1ull << (b % 64);
+        Entry* e = slot(key, h);
+        if (e->deathFrame < 0) { ++used; std::memcpy(e->key, key, sizeof(key)); }
+        e->deathFrame = death;
+    }
+    void grow() {
+        std::vector<Entry> old(table.size() * 2, Entry{{0, 0, 0}, -1});
+        old.swap(table);
+        for (auto const& e : old) {
+            if (e.deathFrame >= 0) *slot(e.key, hashKey(e.key)) = e;
+        }
+    }
+};
+
+// Coast from s (the state at `frame`) for `frames` frames. States on a doomed coast are
+// recorded with their death frame, and any probe entering a recorded state stops there.
+// endState, if given, receives the last state of a surviving probe; it is marked airborne
+// when the probe is known to die just past the window. pre, if given, holds the coasting
+// states from s on (pre[0] == s), already stepped; they are used instead of stepSim.
+static bool probeSurvives(SimState s, int frame, const std::vector<Obj>& objs, int frames, NogoodCache& dead, SimState* endState = nullptr,
+                          const SimState* pre = nullptr, int preLen = 0) {
+    std::vector<SimState>& path = dead.scratch;
+    path.clear();
+    const int end = frame + frames;
+    int death = -1;
+    for (int f=frame; f<end; ++f) {
+        int known = dead.deathFrame(s, f);
+        if (known >= 0) { death = known; break; }
+        path.push_back(s);
+        s = f - frame + 1 < preLen ? pre[f - frame + 1] : stepSim(s, false, objs);
+        if (isDead(s)) { death = f + 1; break; }
+    }
+    if (endState) { *endState = s; if (death >= 0) endState->onGround = false; }
+    if (death < 0) return true;
+    for (size_t i=0; i<path.size(); ++i) dead.add(path[i], frame + (int)i, death);
+    return death > end;
+}
+
+// What the adaptive horizon needs to know about the level: x-extents of everything that
+// can end or redirect a flight, and the lowest surface anything can land on.
+struct HorizonInfo {
+    std::vector<float> hazardX;   // sorted x starts of spikes and pads
+    std::vector<float> hazardEnd; // matching x ends, prefix max so hazardEnd[i] covers 0..i
+    std::vector<float> objX;      // x starts of all objects, sorted, with their indices
+    std::vector<int> objIdx;
+    std::vector<int> wideIdx;     // objects wider than SHORT_OBJ_W
+    float lowestTop = INFINITY;
+
+    explicit HorizonInfo(const std::vector<Obj>& objs) {
+        std::vector<std::pair<float, float>> hz;
+        std::vector<std::pair<float, int>> all;
+        for (int i=0; i<(int)objs.size(); ++i) {
+            const Obj& o = objs[i];
+            all.push_back({o.r.x, i});
+            if (o.type == ObjType::PLATFORM) lowestTop = std::min(lowestTop, o.r.y + o.r.h);
+            else hz.push_back({o.r.x, o.r.x + o.r.w});
+        }
+        std::sort(hz.begin(), hz.end());
+        float reach = -INFINITY;
+        for (auto const& h : hz) {
+            hazardX.push_back(h.first);
+            reach = std::max(reach, h.second);
+            hazardEnd.push_back(reach);
+        }
+        std::sort(all.begin(), all.end());
+        for (auto const& a : all) {
+            if (objs[a.second].r.w > SHORT_OBJ_W) { wideIdx.push_back(a.second); continue; }
+            objX.push_back(a.first);
+            objIdx.push_back(a.second);
+        }
+    }
+    // every object whose x extent overlaps [x0, x1]
+    template <class F> void forEachOverlapping(const std::vector<Obj>& objs, float x0, float x1, F&& fn) const {
+        size_t i = std::lower_bound(objX.begin(), objX.end(), x0 - SHORT_OBJ_W) - objX.begin();
+        for (; i < objX.size() && objX[i] <= x1; ++i) {
+            const Obj& o = objs[objIdx[i]];
+            if (o.r.x + o.r.w >= x0) fn(o);
+        }
+        for (int w : wideIdx) {
+            const Obj& o = objs[w];
+            if (o.r.x <= x1 && o.r.x + o.r.w >= x0) fn(o);
+        }
+    }
+    bool anyHazard(float x0, float x1) const {
+        size_t i = std::upper_bound(hazardX.begin(), hazardX.end(), x1) - hazardX.begin();
+        return i > 0 && hazardEnd[i - 1] >= x0;
+    }
+};
+
+// Hash of what starts in [px, px + window): spikes, pads and platforms at another height
+// than the one the player stands on, relative to the player and snapped to
+// SIGNATURE_GRID, so a repeat of the same pattern elsewhere hashes the same.
+static uint64_t obstacleSignature(const SimState& s, const std::vector<Obj>& objs, const HorizonInfo& info, float window) {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&](long v) { h = (h ^ (uint64_t)v) * 1099511628211ull; };
+    mix(s.onGround);
+    info.forEachOverlapping(objs, s.px, s.px + window, [&](const Obj& o) {
+        if (o.r.x < s.px) return;
+        if (o.type == ObjType::PLATFORM && std::fabs(o.r.y + o.r.h - s.py) < 1e-3f) return;
+        mix((long)o.type);
+        mix(std::lround((o.r.x - s.px) / SIGNATURE_GRID));
+        mix(std::lround((o.r.y - s.py) / SIGNATURE_GRID));
+        mix(std::lround(o.r.w / SIGNATURE_GRID));
+        mix(std::lround(o.r.h / SIGNATURE_GRID));
+    });
+    return h;
+}
+
+// Process-wide memo of coasting probe outcomes. A coasting probe's px sequence is fixed
+// by its start, and stepSim only asks of an object's x extent which of those px lie in it
+// - a run of frames, as px only grows. The key is therefore the probe length, the exact
+// py, vy and onGround, and for every object some frame of the probe overlaps: its type,
+// exact y, height and power, and the first and last frame it overlaps. Where the key
+// repeats, every comparison stepSim makes comes out the same, so a repeated segment - in
+// this level or a later one - is answered exactly without stepping. The objects are kept
+// as two independent hashes and the scalars exactly, and a lookup must match them all.
+// Each shard keeps two generations: when the current one fills up it becomes the old one,
+// the old one is dropped, and hits in the old one are moved back into the current one.
+struct ProbeMemo {
+    struct Outcome { bool survived, endGround; float endPy, endVy; };
+    struct Key {
+        uint64_t hash;      // of everything; picks the shard and bucket
+        uint64_t check;     // second hash of the objects
+        int32_t frames;
+        uint32_t py, vy;    // float bits
+        bool onGround;
+        bool operator==(const Key& o) const {
+            return hash == o.hash && check == o.check && frames == o.frames && py == o.py && vy == o.vy && onGround == o.onGround;
+        }
+    };
+    struct KeyHash { size_t operator()(const Key& k) const { return (size_t)k.hash; } };
+    using Map = std::unordered_map<Key, Outcome, KeyHash>;
+    static constexpr int SHARDS = 16;
+    struct Shard { std::mutex m; Map current, old; };
+    Shard shards[SHARDS];
+
+    static ProbeMemo& get() { static ProbeMemo memo; return memo; }
+
+    static Key key(const SimState& s, int frames, const std::vector<Obj>& objs, const HorizonInfo& info) {
+        // px of frames 1..frames, stepped with stepSim's float operations
+        static thread_local std::vector<float> px;
+        px.resize(frames);
+        float x = s.px;
+        for (int f=0; f<frames; ++f) px[f] = x += PLAYER_SPEED * FRAME_DT;
+        uint64_t layout = 0, check = 0;
+        info.forEachOverlapping(objs, px.front(), px.back(), [&](const Obj& o) {
+            const int first = (int)(std::lower_bound(px.begin(), px.end(), o.r.x) - px.begin());
+            const int last = (int)(std::upper_bound(px.begin(), px.end(), o.r.x + o.r.w) - px.begin()) - 1;
+            if (first > last) return;
+            uint32_t y, h, power;
+            std::memcpy(&y, &o.r.y, 4);
+            std::memcpy(&h, &o.r.h, 4);
+            std::memcpy(&power, &o.power, 4);
+            uint64_t v = 1469598103934665603ull;
+            auto mix = [&](uint64_t w) { v = (v ^ w) * 1099511628211ull; };
+            mix((uint64_t)o.type);
+            mix(y); mix(h); mix(power);
+            mix((uint64_t)first << 32 | (uint32_t)last);
+            layout += v * 0x9E3779B97F4A7C15ull;   // order-independent combines
+            uint64_t z = v + 0x9E3779B97F4A7C15ull;   // splitmix64 finalizer, independent of the first
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            check += z ^ (z >> 31);
+        });
+        Key k;
+        k.check = check;
+        k.frames = frames;
+        std::memcpy(&k.py, &s.py, 4);
+        std::memcpy(&k.vy, &s.vy, 4);
+        k.onGround = s.onGround;
+        uint64_t hv = layout ^ ((uint64_t)frames << 1 | (s.onGround ? 1 : 0)) * 0xBF58476D1CE4E5B9ull;
+        hv ^= ((uint64_t)k.py << 32 | k.vy) * 0x94D049BB133111EBull;
+        k.hash = hv ^ (hv >> 31);
+        return k;
+    }
+    void clear() {
+        for (Shard& sh : shards) {
+            std::lock_guard<std::mutex> lock(sh.m);
+            sh.current.clear();
+            sh.old.clear();
+        }
+    }
+    bool find(const Key& k, Outcome& out) {
+        Shard& sh = shards[k.hash % SHARDS];
+        std::lock_guard<std::mutex> lock(sh.m);
+        auto it = sh.current.find(k);
+        if (it != sh.current.end()) { out = it->second; return true; }
+        auto ot = sh.old.find(k);
+        if (ot == sh.old.end()) return false;
+        out = ot->second;
+        sh.old.erase(ot);
+        insert(sh, k, out);
+        return true;
+    }
+    void store(const Key& k, const Outcome& o) {
+        Shard& sh = shards[k.hash % SHARDS];
+        std::lock_guard<std::mutex> lock(sh.m);
+        insert(sh, k, o);
+    }
+private:
+    static void insert(Shard& sh, const Key& k, const Outcome& o) {
+        if (sh.current.size() >= MEMO_GENERATION) {
+            sh.old = std::move(sh.current);
+            sh.current = Map();
+        }
+        sh.current[k] = o;
+    }
+};
+
+// Takeoff delays that worked before, per obstacle signature. Decisions try the delays in
+// order of past wins, then earliest first.
+struct MoveHistory {
+    std::unordered_map<uint64_t, std::vector<uint32_t>> wins;
+
+    void order(uint64_t sig, int maxDelay, std::vector<int>& out) const {
+        out.clear();
+        for (int d=0; d<=maxDelay; ++d) out.push_back(d);
+        auto it = wins.find(sig);
+        if (it == wins.end()) return;
+        const std::vector<uint32_t>& w = it->second;
+        auto score = [&](int d) { return d < (int)w.size() ? w[d] : 0u; };
+        std::stable_sort(out.begin(), out.end(), [&](int a, int b) { return score(a) > score(b); });
+    }
+    void record(uint64_t sig, int delay) {
+        std::vector<uint32_t>& w = wins[sig];
+        if ((int)w.size() <= delay) w.resize(delay + 1, 0);
+        ++w[delay];
+    }
+};
+
+// Read-only view of a whole file: mmap where the platform has it, otherwise read into memory.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const std::filesystem::path& p, std::string& err) {
+        close();
+#if defined(__unix__) || defined(__APPLE__)
+        int fd = ::open(p.c_str(), O_RDONLY);
+        if (fd < 0) { err = "cannot open " + p.string(); return false; }
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); err = "cannot stat " + p.string(); return false; }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m == MAP_FAILED) { ::close(fd); length = 0; err = "cannot map " + p.string(); return false; }
+            bytes = (const char*)m;
+            mapped = true;
+        }
+        ::close(fd);
+#else
+        std::ifstream f(p, std::ios::binary);
+        if (!f) { err = "cannot open " + p.string(); return false; }
+        buf.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        bytes = buf.data();
+        length = buf.size();
+#endif
+        return true;
+    }
+    void close() {
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapped) munmap((void*)bytes, length);
+#endif
+        buf.clear();
+        bytes = nullptr;
+        length = 0;
+        mapped = false;
+    }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+
+    // Drops the whole pages of [from, to) from memory; touching them reads them in again.
+    void release(size_t from, size_t to) {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!mapped) return;
+        const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        from = (from + page - 1) / page * page;
+        to = std::min(to, length) / page * page;
+        if (to > from) madvise((void*)(bytes + from), to - from, MADV_DONTNEED);
+#endif
+    }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool mapped = false;
+    std::vector<char> buf;
+};
+
+// Solved takeoffs for recurring obstacle clusters. A cluster is everything overlapping
+// [x - PATTERN_LEAD, x + PATTERN_SPAN] around a hazard at x, clipped to that window and
+// taken relative to x and the ground the player approaches on. A record holds the
+// takeoff x positions relative to the hazard in quarter px.
+struct PatternRecord {
+    uint64_t key;
+    int16_t offsets[PATTERN_MAX_JUMPS];
+    uint16_t jumps;
+    uint16_t weight;   // times the sequence was seen in training
+};
+static_assert(sizeof(PatternRecord) == 24, "pattern file layout");
+
+// Pattern file (.pfp): this header, then `count` records sorted by key, native byte order.
+struct PatternFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t recordSize;
+};
+static constexpr char PATTERN_MAGIC[4] = {'P', 'F', 'P', 'L'};
+static constexpr uint32_t PATTERN_VERSION = 1;
+
+// Process-wide pattern library, searched in place in the mapped file. Load it before any
+// solve starts; solves only read it.
+class PatternLibrary {
+public:
+    static PatternLibrary& get() { static PatternLibrary lib; return lib; }
+
+    static uint64_t key(const std::vector<Obj>& objs, const HorizonInfo& info, float hazardX, float groundY) {
+        const float x0 = hazardX - PATTERN_LEAD, x1 = hazardX + PATTERN_SPAN;
+        uint64_t layout = 0;
+        info.forEachOverlapping(objs, x0, x1, [&](const Obj& o) {
+            uint64_t h = 1469598103934665603ull;
+            auto mix = [&](long v) { h = (h ^ (uint64_t)v) * 1099511628211ull; };
+            mix((long)o.type);
+            mix(std::lround(std::max(o.r.x, x0) - hazardX));
+            mix(std::lround(std::min(o.r.x + o.r.w, x1) - hazardX));
+            mix(std::lround(o.r.y - groundY));
+            mix(std::lround(o.r.h));
+            mix(std::lround(o.power));
+            layout += h * 0x9E3779B97F4A7C15ull;   // order-independent combine
+        });
+        return layout ^ (layout >> 31);
+    }
+
+    bool load(const std::filesystem::path& p, std::string& err) {
+        records = nullptr;
+        count = 0;
+        if (!file.open(p, err)) return false;
+        PatternFileHeader hdr;
+        if (file.size() < sizeof(hdr)) { err = "pattern file too short"; return false; }
+        std::memcpy(&hdr, file.data(), sizeof(hdr));
+        if (std::memcmp(hdr.magic, PATTERN_MAGIC, 4) != 0) { err = "not a pattern file"; return false; }
+        if (hdr.version != PATTERN_VERSION || hdr.recordSize != sizeof(PatternRecord)) { err = "unsupported pattern file version"; return false; }
+        if (file.size() < sizeof(hdr) + (size_t)hdr.count * sizeof(PatternRecord)) { err = "pattern file truncated"; return false; }
+        records = reinterpret_cast<const PatternRecord*>(file.data() + sizeof(hdr));
+        count = hdr.count;
+        return true;
+    }
+    bool loaded() const { return count > 0; }
+    size_t size() const { return count; }
+
+    const PatternRecord* find(uint64_t k) const {
+        const PatternRecord* end = records + count;
+        const PatternRecord* it = std::lower_bound(records, end, k, [](const PatternRecord& r, uint64_t v) { return r.key < v; });
+        return it != end && it->key == k ? it : nullptr;
+    }
+
+    static bool save(const std::filesystem::path& p, std::vector<PatternRecord> recs, std::string& err) {
+        std::sort(recs.begin(), recs.end(), [](const PatternRecord& a, const PatternRecord& b) { return a.key < b.key; });
+        PatternFileHeader hdr;
+        std::memcpy(hdr.magic, PATTERN_MAGIC, 4);
+        hdr.version = PATTERN_VERSION;
+        hdr.count = (uint32_t)recs.size();
+        hdr.recordSize = sizeof(PatternRecord);
+        std::ofstream f(p, std::ios::binary | std::ios::trunc);
+        f.write((const char*)&hdr, sizeof(hdr));
+        f.write((const char*)recs.data(), (std::streamsize)(recs.size() * sizeof(PatternRecord)));
+        if (!f) { err = "cannot write " + p.string(); return false; }
+        return true;
+    }
+
+private:
+    MappedFile file;
+    const PatternRecord* records = nullptr;
+    size_t count = 0;
+};
+
+// Probe length for a state: long enough to see the whole flight a decision here can start
+// (a jump from the ground, or the current arc) down to the lowest surface, and short when
+// nothing lies ahead in that stretch.
+static int adaptiveHorizon(const SimState& s, const HorizonInfo& info) {
+    const float g = -GRAVITY;
+    float vy = s.onGround ? JUMP_VELOCITY : s.vy;
+    float apex = s.py + (vy > 0.0f ? vy * vy / (2.0f * g) : 0.0f);
+    float floorY = std::isfinite(info.lowestTop) && info.lowestTop < apex ? info.lowestTop : s.py - 1000.0f;
+    float t = std::max(vy, 0.0f) / g + std::sqrt(2.0f * std::max(apex - floorY, 0.0f) / g);
+    int frames = (int)std::ceil(t / FRAME_DT) + 1;
+    if (!info.anyHazard(s.px, s.px + frames * PLAYER_SPEED * FRAME_DT)) frames = HORIZON_EMPTY;
+    return std::max(HORIZON_MIN, std::min(frames, HORIZON_MAX));
+}
+
+// Stepped states handed to a probe in place of stepSim calls.
+struct ProbePath {
+    const SimState* states = nullptr;
+    int len = 0;
+};
+
+// Background stepping for a greedy run. From the committed state it keeps the coasting
+// trajectory and has workers step, for each of the next SPEC_AHEAD frames, the path of
+// jumping on that frame. Only those jump paths run on the workers: the coasting
+// trajectory is a serial chain and is extended by the planner itself (one state per
+// frame once warm), so the coasting lookahead and the takeoff states of the delayed-jump
+// trials are planner work, as is any probe that runs past the end of a path. Both are
+// pure functions of the committed state, so the planner probes them exactly as it would
+// step them alone; when it commits a jump the paths are stale and it rebases.
+class GreedySpeculator {
+public:
+    GreedySpeculator(const std::vector<Obj>& objs, int workers)
+        : objs(objs), coastBuf(SPEC_EPOCH + HORIZON_MAX + 2), slots(SPEC_RING) {
+        for (Slot& sl : slots) sl.states.resize(HORIZON_MAX + 2);
+        for (int i=0; i<workers; ++i) pool.emplace_back([this]() { work(); });
+    }
+    ~GreedySpeculator() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            quit = true;
+            active = false;
+        }
+        cv.notify_all();
+        for (auto& t : pool) t.join();
+    }
+
+    // start over from the committed state at `frame`, once the workers are out of the old paths
+    void rebase(const SimState& s, int frame) {
+        active = false;
+        while (busy > 0) std::this_thread::yield();
+        base = frame;
+        coastBuf[0] = s;
+        coastLen = 1;
+        for (Slot& sl : slots) sl.tag = 0;
+        mainIdx = 0;
+        nextJump = 0;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            active = true;
+        }
+        cv.notify_all();
+    }
+    bool exhausted(int frame) const { return frame - base + HORIZON_MAX + 2 > (int)coastBuf.size(); }
+
+    // coasting states from `frame` on, `len` of them (fewer at the end of the epoch)
+    ProbePath coast(int frame, int len) {
+        const int i = frame - base;
+        mainIdx = i;
+        int have = coastLen;
+        const int want = std::min(i + len, (int)coastBuf.size());
+        for (; have < want; ++have) coastBuf[have] = stepSim(coastBuf[have - 1], false, objs);
+        coastLen = have;
+        // parked workers have new frames to step
+        if (idle > 0) {
+            { std::lock_guard<std::mutex> lock(m); }
+            cv.notify_all();
+        }
+        return {&coastBuf[i], have - i};
+    }
+    // the states from just after jumping at `frame` on, if a worker has stepped them
+    ProbePath jump(int frame) {
+        const int i = frame - base;
+        if (i < 0) return {};
+        const Slot& sl = slots[i % SPEC_RING];
+        if (sl.tag != i + 1) return {};
+        ++used;
+        return {sl.states.data(), sl.len};
+    }
+    long long used = 0;
+    std::atomic<long long> computed{0};
+
+private:
+    struct Slot {
+        std::atomic<int> tag{0};   // index + 1 once the path is complete
+        int len = 0;
+        std::vector<SimState> states;
+    };
+    // a frame within SPEC_AHEAD of the planner whose jump path nobody has stepped
+    bool hasWork() const { return nextJump < std::min<int>(mainIdx + SPEC_AHEAD, coastLen); }
+    void work() {
+        for (;;) {
+            {
+                // parked until a rebase or the planner's next frame; idle is raised first
+                // so a planner that moves on after the check below sees it and wakes us
+                std::unique_lock<std::mutex> lock(m);
+                ++idle;
+                cv.wait(lock, [&] { return quit || (active && hasWork()); });
+                --idle;
+                if (quit) return;
+            }
+            ++busy;
+            if (!active) {   // a rebase is under way; read nothing until it is done
+                --busy;
+                continue;
+            }
+            int i = nextJump;
+            const int lo = mainIdx, hi = std::min<int>(lo + SPEC_AHEAD, coastLen);
+            if (i >= hi) {
+                --busy;
+                continue;
+            }
+            if (i < lo) {
+                nextJump.compare_exchange_strong(i, lo);   // the planner moved past these
+                --busy;
+                continue;
+            }
+            if (nextJump.compare_exchange_strong(i, i + 1) && coastBuf[i].onGround) {
+                Slot& sl = slots[i % SPEC_RING];
+                sl.tag = 0;
+                int n = 0;
+                sl.states[n++] = stepSim(coastBuf[i], true, objs);
+                while (n < (int)sl.states.size() && !isDead(sl.states[n - 1])) {
+                    sl.states[n] = stepSim(sl.states[n - 1], false, objs);
+                    ++n;
+                }
+                sl.len = n;
+                sl.tag = i + 1;
+                ++computed;
+            }
+            --busy;
+        }
+    }
+
+    const std::vector<Obj>& objs;
+    std::vector<SimState> coastBuf;
+    std::vector<Slot> slots;
+    int base = 0;
+    std::atomic<int> coastLen{0}, mainIdx{0}, nextJump{0}, busy{0}, idle{0};
+    std::atomic<bool> active{false};
+    bool quit = false;
+    std::mutex m;
+    std::condition_variable cv;
+    std::vector<std::thread> pool;
+};
+
+struct GreedyOptions {
+    bool adaptiveHorizon = true;
+    bool moveOrdering = true;
+    bool probeMemo = true;
+    bool patterns = true;       // try PatternLibrary::get() at decisions
+    bool speculate = false;     // step through a GreedySpeculator
+    int workers = 0;            // its jump-path threads; with none it only shares the coasting trajectory
+    int granularity = 1;        // decide (check and jump) only on frames that are multiples of this
+    const std::vector<int>* windows = nullptr;   // if set, sorted frames: decide only within
+    int windowRadius = 0;                        // ... this many frames of one of them
+};
+
+struct GreedyStats {
+    long long decisions = 0;
+    long long probes = 0;       // jump candidates probed at decisions
+    long long memoLookups = 0, memoHits = 0;
+    long long patternLookups = 0, patternHits = 0;
+    long long specUsed = 0, specComputed = 0;
+    int endFrame = 0;           // frame the run succeeded, failed or stopped at
+};
+
+// Greedy planner: coast while a lookahead probe survives, otherwise take the first jump
+// whose probe survives. With adaptiveHorizon the probe length comes from the flight time
+// (see adaptiveHorizon) and a probe that ends mid-air is deepened; otherwise it is the
+// fixed LOOKAHEAD. With moveOrdering the takeoff delays are tried in MoveHistory order
+// instead of earliest first. With patterns a grounded decision first looks up the cluster
+// at the next hazard in the library and takes its jumps if one simulation through the
+// cluster survives and lands. With speculate the stepping goes through a GreedySpeculator
+// (ahead of the planner on its worker threads); decisions and macro are unchanged.
+static bool runGreedy(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl, const GreedyOptions& opt, GreedyStats* stats = nullptr) {
     outJumps.clear();
+    const bool adaptive = opt.adaptiveHorizon;
     std::ostringstream rep;
     rep << "Pathfinder run\n";
     rep << "Objects: " << objs.size() << "\n";
     SimState state = start;
-    const int lookahead = LOOKAHEAD;
+    NogoodCache dead;
+    HorizonInfo info(objs);
+    ProbeMemo& memo = ProbeMemo::get();
+    const PatternLibrary& library = PatternLibrary::get();
+    GreedyStats st;
+    std::unique_ptr<GreedySpeculator> spec;
+    if (opt.speculate) {
+        spec.reset(new GreedySpeculator(objs, opt.workers));
+        spec->rebase(state, 0);
+    }
+    auto probe = [&](const SimState& s, int frame, int h, SimState& end, const ProbePath& path) {
+        if (!opt.probeMemo) return probeSurvives(s, frame, objs, h, dead, &end, path.states, path.len);
+        const ProbeMemo::Key key = ProbeMemo::key(s, h, objs, info);
+        ProbeMemo::Outcome o;
+        ++st.memoLookups;
+        if (memo.find(key, o)) {
+            ++st.memoHits;
+            end = s;
+            end.py = o.endPy; end.vy = o.endVy; end.onGround = o.endGround;
+            return o.survived;
+        }
+        bool ok = probeSurvives(s, frame, objs, h, dead, &end, path.states, path.len);
+        // a survivor ending mid-air may have been cut short by a nogood past the window,
+        // which holds for this level only
+        if (!ok || end.onGround) memo.store(key, {ok, end.onGround, end.py, end.vy});
+        return ok;
+    };
+    auto safe = [&](const SimState& s, int frame, const ProbePath& path) {
+        SimState end;
+        if (!adaptive) return probe(s, frame, LOOKAHEAD, end, path);
+        // nothing past the goal matters
+        const int toGoal = std::max(1, (int)std::ceil((goalX - s.px) / (PLAYER_SPEED * FRAME_DT)));
+        int h = std::min(adaptiveHorizon(s, info), toGoal);
+        for (;;) {
+            if (!probe(s, frame, h, end, path)) return false;
+            if (end.onGround || h >= HORIZON_MAX || h >= toGoal) return true;
+            h = std::min({h * 2, HORIZON_MAX, toGoal});
+        }
+    };
+    auto decides = [&](int frame) {
+        if (frame % opt.granularity != 0) return false;
+        if (!opt.windows) return true;
+        auto it = std::lower_bound(opt.windows->begin(), opt.windows->end(), frame - opt.windowRadius);
+        return it != opt.windows->end() && *it <= frame + opt.windowRadius;
+    };
+    MoveHistory history;
+    std::vector<int> candidates;
+    std::vector<SimState> trials;
+    auto finish = [&](bool ok, int frame) {
+        st.endFrame = frame;
+        rep << "Decisions: " << st.decisions << ", jump probes: " << st.probes;
+        if (st.decisions) rep << " (" << std::fixed << std::setprecision(2) << (double)st.probes / st.decisions << " per decision)";
+        rep << ", patterns seen: " << history.wins.size() << "\n";
+        rep << "Probe memo: " << st.memoHits << " hits / " << st.memoLookups << " lookups\n";
+        if (spec) {
+            st.specUsed = spec->used;
+            st.specComputed = spec->computed;
+            rep << "Speculation: " << st.specUsed << " jump paths used / " << st.specComputed << " stepped by " << opt.workers << " workers\n";
+        }
+        if (opt.patterns && library.loaded()) rep << "Pattern library: " << st.patternHits << " hits / " << st.patternLookups << " lookups\n";
+        if (stats) *stats = st;
+        rep << "Nogood cache: " << dead.used << " states, " << dead.hits << " hits / " << dead.lookups << " lookups";
+        if (dead.lookups) rep << " (" << std::fixed << std::setprecision(1) << 100.0 * dead.hits / dead.lookups << "%)";
+        rep << "\n";
+        report = rep.str();
+        return ok;
+    };
     for (int frame=0; frame<MAX_FRAMES; ++frame) {
         if (state.px >= goalX) {
             rep << "Success at frame " << frame << "\n";
-            report = rep.str();
-            return true;
+            return finish(true, frame);
         }
-        SimState look = state;
-        bool willDie = false;
-        for (int la=0; la<lookahead; ++la) {
-            look = stepSim(look, false, objs);
-            if (look.py < -1000.0f) { willDie = true; break; }
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped at frame " << frame << "\n";
+            return finish(false, frame);
         }
-        if (!willDie) {
-            state = stepSim(state, false, objs);
+        if (spec && spec->exhausted(frame)) spec->rebase(state, frame);
+        const ProbePath ahead = spec ? spec->coast(frame, HORIZON_MAX + 2) : ProbePath{};
+        // between decision frames the player just coasts
+        if (!decides(frame) || safe(state, frame, ahead)) {
+            state = ahead.len > 1 ? ahead.states[1] : stepSim(state, false, objs);
+            if (isDead(state)) {
+                rep << "Died coasting at frame " << frame << "\n";
+                return finish(false, frame);
+            }
             continue;
         }
-        if (state.onGround) {
-            SimState after = stepSim(state, true, objs);
-            SimState probe = after;
-            bool ok = true;
-            for (int la=0; la<lookahead; ++la) {
-                probe = stepSim(probe, false, objs);
-                if (probe.py < -1000.0f) { ok = false; break; }
-            }
-            if (ok) {
-                outJumps.push_back(frame);
-                rep << "Jump at frame " << frame << "\n";
-                state = after;
-                continue;
+        if (opt.patterns && library.loaded() && state.onGround) {
+            // replay the stored takeoffs through the cluster; accept only if it lands
+            ++st.patternLookups;
+            size_t hi = std::lower_bound(info.hazardX.begin(), info.hazardX.end(), state.px) - info.hazardX.begin();
+            const float hx = hi < info.hazardX.size() ? info.hazardX[hi] : INFINITY;
+            const PatternRecord* rec = std::isfinite(hx) ? library.find(PatternLibrary::key(objs, info, hx, state.py)) : nullptr;
+            std::vector<int> planned;
+            for (int j=0; rec && j<rec->jumps; ++j) {
+                int at = frame + (int)std::lround((hx + rec->offsets[j] * 0.25f - state.px) / (PLAYER_SPEED * FRAME_DT));
+                if (at < frame || (!planned.empty() && at <= planned.back())) { planned.clear(); break; }
+                planned.push_back(at);
+            }
+            if (!planned.empty()) {
+                SimState s = state;
+                int f = frame;
+                size_t next = 0;
+                const int limit = frame + (int)std::ceil((hx + PATTERN_SPAN - state.px) / (PLAYER_SPEED * FRAME_DT)) + HORIZON_MAX;
+                bool ok = true;
+                while (s.px < goalX && (next < planned.size() || s.px < hx + PATTERN_SPAN || !s.onGround)) {
+                    const bool jump = next < planned.size() && planned[next] == f;
+                    if (f > limit || (jump && !s.onGround)) { ok = false; break; }
+                    s = stepSim(s, jump, objs);
+                    next += jump;
+                    ++f;
+                    if (isDead(s)) { ok = false; break; }
+                }
+                planned.resize(next);   // takeoffs past the goal are not needed
+                // the landing must leave a way on, as any greedy step would
+                if (ok && s.px < goalX) ok = safe(s, f, ProbePath{});
+                if (ok) {
+                    ++st.patternHits;
+                    if (spec) spec->rebase(s, f);
+                    outJumps.insert(outJumps.end(), planned.begin(), planned.end());
+                    rep << "Pattern at frame " << frame << ": " << planned.size() << " jumps\n";
+                    state = s;
+                    frame = f - 1;
+                    continue;
+                }
             }
         }
+        // with the adaptive horizon the hazard can be a whole flight away, so later
+        // takeoffs up to that horizon are worth trying too
+        const int maxDelay = adaptive ? std::max(MAX_DELAY, adaptiveHorizon(state, info)) : MAX_DELAY;
+        trials.assign(1, state);
+        for (int d=1; d<=maxDelay && !isDead(trials.back()); ++d)
+            trials.push_back(d < ahead.len ? ahead.states[d] : stepSim(trials.back(), false, objs));
+        const uint64_t sig = opt.moveOrdering ? obstacleSignature(state, objs, info, maxDelay * PLAYER_SPEED * FRAME_DT + 200.0f) : 0;
+        if (opt.moveOrdering) history.order(sig, (int)trials.size() - 1, candidates);
+        else { candidates.clear(); for (int d=0; d<(int)trials.size(); ++d) candidates.push_back(d); }
+        ++st.decisions;
         bool scheduled = false;
-        for (int delay=1; delay<=8; ++delay) {
-            SimState trial = state;
-            for (int d=0; d<delay; ++d) trial = stepSim(trial, false, objs);
-            if (!trial.onGround) continue;
-            SimState after = stepSim(trial, true, objs);
-            SimState probe = after;
-            bool ok = true;
-            for (int la=0; la<lookahead; ++la) {
-                probe = stepSim(probe, false, objs);
-                if (probe.py < -1000.0f) { ok = false; break; }
-            }
-            if (ok) {
+        for (int delay : candidates) {
+            const SimState& trial = trials[delay];
+            if (!trial.onGround || isDead(trial) || !decides(frame + delay)) continue;
+            ++st.probes;
+            const ProbePath jumped = spec ? spec->jump(frame + delay) : ProbePath{};
+            SimState after = jumped.len > 0 ? jumped.states[0] : stepSim(trial, true, objs);
+            if (!isDead(after) && safe(after, frame + delay + 1, jumped)) {
                 outJumps.push_back(frame + delay);
-                rep << "Delayed jump at frame " << frame + delay << "\n";
-                for (int d=0; d<delay; ++d) state = stepSim(state, false, objs);
-                state = stepSim(state, true, objs);
+                if (delay == 0) rep << "Jump at frame " << frame << "\n";
+                else rep << "Delayed jump at frame " << frame + delay << "\n";
+                if (opt.moveOrdering) history.record(sig, delay);
+                state = after;
+                frame += delay;
+                if (spec) spec->rebase(state, frame + 1);
                 scheduled = true;
                 break;
             }
         }
         if (scheduled) continue;
         rep << "Failed at frame " << frame << "\n";
-        report = rep.str();
-        return false;
+        return finish(false, frame);
     }
     rep << "Failed: max frames exceeded\n";
-    report = rep.str();
-    return false;
+    return finish(false, MAX_FRAMES);
 }
 
-// parse level.txt fallback
-static bool parseLevelFile(const std::filesystem::path& p, std::vector<Obj>& out, std::string& dbg) {
-    out.clear();
-    std::ifstream ifs(p);
-    if (!ifs.is_open()) { dbg = "file not found"; return false; }
-    std::string line; int ln=0;
-    std::ostringstream dbgoss;
-    while (std::getline(ifs, line)) {
-        ++ln;
-        auto trim = [&](std::string s)->std::string {
-            size_t a = s.find_first_not_of(" \\t\\r\\n");
-            if (a==std::string::npos) return "";
-            size_t b = s.find_last_not_of(" \\t\\r\\n");
-            return s.substr(a, b-a+1);
-        };
-        line = trim(line);
-        if (line.empty() || line[0]=='#') continue;
-        std::stringstream ss(line);
-        std::string tok; std::vector<std::string> toks;
-        while (std::getline(ss, tok, ',')) toks.push_back(trim(tok));
-        if (toks.empty()) continue;
-        std::string t = toks[0];
-        for (auto &c : t) c = (char)toupper((unsigned char)c);
-        try {
-            if (t == "PLATFORM") {
-                if (toks.size() < 5) { dbgoss << "parse error line " << ln; dbg = dbgoss.str(); return false; }
-                Obj o; o.type = ObjType::PLATFORM;
-                o.r.x = std::stof(toks[1]); o.r.y = std::stof(toks[2]);
-                o.r.w = std::stof(toks[3]); o.r.h = std::stof(toks[4]);
-                out.push_back(o);
-            } else if (t == "SPIKE") {
-                if (toks.size() < 5) { dbgoss << "parse error line " << ln; dbg = dbgoss.str(); return false; }
-                Obj o; o.type = ObjType::SPIKE;
-                o.r.x = std::stof(toks[1]); o.r.y = std::stof(toks[2]);
-                o.r.w = std::stof(toks[3]); o.r.h = std::stof(toks[4]);
-                out.push_back(o);
-            } else if (t == "JUMP_PAD") {
-                if (toks.size() < 4) { dbgoss << "parse error line " << ln; dbg = dbgoss.str(); return false; }
-                Obj o; o.type = ObjType::JUMP_PAD;
-                o.r.x = std::stof(toks[1]); o.r.y = std::stof(toks[2]);
-                o.r.w = toks.size() >= 4 ? std::stof(toks[3]) : 16.0f;
-                o.r.h = 16.0f;
-                o.power = (toks.size() >= 5) ? std::stof(toks[4]) : JUMP_VELOCITY;
-                out.push_back(o);
-            } else {
-                dbgoss << "ignored line " << ln << "\\n";
-            }
-        } catch (...) {
-            dbgoss << "parse exception at line " << ln << "\\n";
-            dbg = dbgoss.str();
-            return false;
-        }
-    }
-    dbg = dbgoss.str();
-    return true;
+// Greedy with the default options, speculating on `workers` threads.
+static bool runPathfinderWith(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl, int workers) {
+    GreedyOptions opt;
+    opt.speculate = true;
+    opt.workers = workers;
+    GreedyStats stats;
+    if (runGreedy(objs, start, goalX, outJumps, report, ctl, opt, &stats)) return true;
+    if (stats.patternHits == 0 || (ctl && ctl->stopped())) return false;
+    // library jumps put the planner on a path it may not finish from; retry without them
+    opt.patterns = false;
+    std::string first = report;
+    bool ok = runGreedy(objs, start, goalX, outJumps, report, ctl, opt);
+    report = first + "Retrying without pattern library\n" + report;
+    return ok;
 }
 
-// safe live extractor: attempt PlayLayer->m_level->m_objects guardedly; if not possible, return false
-static bool extractLive(std::vector<Obj>& out, std::string& dbg) {
-    out.clear();
-    dbg.clear();
-    PlayLayer* pl = nullptr;
-    try { pl = PlayLayer::get(); } catch(...) { pl = nullptr; }
-    if (!pl) { dbg = "PlayLayer not found"; return false; }
-    GJGameLevel* level = nullptr;
-    try { level = pl->m_level; } catch(...) { level = nullptr; }
-    if (!level) { dbg = "level ptr not found"; return false; }
-    cocos2d::CCArray* arr = nullptr;
-    try { arr = level->m_objectList; } catch(...) { arr = nullptr; }
-    if (!arr) {
-        try { arr = level->m_objects; } catch(...) { arr = nullptr; }
-    }
-    if (!arr) {
-        try { arr = level->m_objectArray; } catch(...) { arr = nullptr; }
-    }
-    if (!arr) { dbg = "objects array not found"; return false; }
-    // attempt to cast to GameObject where available
-    for (int i=0;i<(int)arr->count();++i) {
-        cocos2d::CCObject* o = arr->objectAtIndex(i);
-        if (!o) continue;
-        // Try to treat as GameObject if binding present
-        GameObject* go = nullptr;
-        try { go = static_cast<GameObject*>(o); } catch(...) { go = nullptr; }
-        if (!go) continue;
-        // attempt to read common fields (m_x,m_y). If not present, skip object.
-        float ox=0, oy=0, ow=16, oh=16;
-        bool ok=false;
-        try { ox = go->m_x; oy = go->m_y; ok = true; } catch(...) { ok=false; }
-        if (!ok) {
-            try { ox = go->getX(); oy = go->getY(); ok = true; } catch(...) { ok=false; }
-        }
-        if (!ok) continue;
-        Obj obj;
-        obj.r.x = ox; obj.r.y = oy; obj.r.w = ow; obj.r.h = oh;
-        // heuristic for spikes: small h or w
-        if (obj.r.h <= 10.0f || obj.r.w <= 10.0f) obj.type = ObjType::SPIKE;
-        else obj.type = ObjType::PLATFORM;
-        out.push_back(obj);
-    }
-    dbg = "extracted " + std::to_string(out.size()) + " objects";
-    return !out.empty();
+static int speculativeWorkers() {
+    const int hw = (int)std::thread::hardware_concurrency();
+    return std::max(0, std::min(hw - 1, SPEC_MAX_WORKERS));
 }
 
-class PathfinderPopup : public FLAlertLayerProtocol {
-public:
-    std::filesystem::path saveDir;
-    PathfinderPopup() {
-        try { saveDir = Mod::get()->getSaveDir(); } catch(...) { saveDir = std::filesystem::current_path(); }
+// Greedy, speculating on as many threads as ctl asks for (none by default).
+static bool runPathfinder(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    return runPathfinderWith(objs, start, goalX, outJumps, report, ctl, ctl ? ctl->speculativeWorkers : 0);
+}
+
+// Decision point for the backtracking solver: a state and the takeoff delays from it
+// still to try, nextDelay..maxDelay. Where coasting dies they are every delay greedy would
+// try. On a grounded frame where coasting is safe, coasting on is taken first and the one
+// alternative left is jumping right there (maxDelay 0); later takeoffs are the next
+// frames' checkpoints.
+struct Checkpoint {
+    SimState state;
+    int frame;
+    int nextDelay;
+    int maxDelay;
+    int jumpCount;
+};
+
+// Fixed-size undo stack. Pushing past capacity overwrites the oldest checkpoint,
+// so memory stays constant and only the most recent BT_RING decisions can be undone.
+struct CheckpointRing {
+    std::array<Checkpoint, BT_RING> buf{};
+    int top = BT_RING - 1;
+    int count = 0;
+    int dropped = 0;
+
+    bool empty() const { return count == 0; }
+    Checkpoint& peek() { return buf[top]; }
+    void push(const Checkpoint& c) {
+        top = (top + 1) % BT_RING;
+        buf[top] = c;
+        if (count < BT_RING) ++count; else ++dropped;
     }
-    void show() {
-        std::ostringstream ss;
-        ss << "Pathfinder (single-file)\\n\\n";
-        ss << "Press RUN to attempt live extraction (PlayLayer). If that fails, fallback to level.txt.\\n\\n";
-        ss << "Save dir: " << saveDir.string() << "\\n\\n";
-        ss << "Create level.txt in the save dir if needed. Format: PLATFORM,x,y,w,h  SPIKE,x,y,w,h  JUMP_PAD,x,y,w[,power]\\n\\n";
-        ss << "Press RUN to start.";
-        FLAlertLayer::create(this, "Pathfinder", ss.str(), "RUN", "CANCEL")->show();
+    void pop() {
+        top = (top + BT_RING - 1) % BT_RING;
+        --count;
     }
-    void FLAlert_Clicked(FLAlertLayer*, int btn) override {
-        if (btn==0) run();
+};
+
+// Greedy's adaptive safety test, stepping every probe: coast for adaptiveHorizon frames,
+// deepening while the probe ends in the air. Nothing past goalX matters.
+static bool horizonSurvives(const SimState& s, int frame, const std::vector<Obj>& objs, const HorizonInfo& info, float goalX, NogoodCache& dead) {
+    const int toGoal = std::max(1, (int)std::ceil((goalX - s.px) / (PLAYER_SPEED * FRAME_DT)));
+    int h = std::min(adaptiveHorizon(s, info), toGoal);
+    SimState end;
+    for (;;) {
+        if (!probeSurvives(s, frame, objs, h, dead, &end)) return false;
+        if (end.onGround || h >= HORIZON_MAX || h >= toGoal) return true;
+        h = std::min({h * 2, HORIZON_MAX, toGoal});
     }
-    void run() {
-        std::vector<Obj> objs;
-        std::string dbg;
-        bool ok = extractLive(objs, dbg);
-        if (!ok) {
-            // try file fallback
-            auto p = (Mod::get()->getSaveDir() / "level.txt");
-            std::string filedbg;
-            if (!parseLevelFile(p, objs, filedbg)) {
-                std::ostringstream oss;
-                oss << "Pathfinder: failed to read level. live: " << dbg << " file: " << filedbg;
-                geode::Notification::create(oss.str(), geode::NotificationIcon::Exclamation, 6.0f)->show();
-                // write report
-                auto report = (Mod::get()->getSaveDir() / "pathfinder_report.txt");
-                std::ofstream rf(report.string(), std::ios::trunc);
-                rf << "live debug:\\n" << dbg << "\\nfile debug:\\n" << filedbg << "\\n";
-                rf.close();
-                GEODE_ERROR("[Pathfinder] extraction failed: %s | %s", dbg.c_str(), filedbg.c_str());
-                return;
-            }
+}
+
+// Try the remaining jump delays of a checkpoint. On success the checkpoint is advanced
+// past the chosen delay and state/frame are set to the frame after the jump.
+static bool takeNextAlternative(Checkpoint& cp, const std::vector<Obj>& objs, const HorizonInfo& info, float goalX, SimState& state, int& frame,
+                                std::vector<int>& outJumps, NogoodCache& dead) {
+    SimState trial = cp.state;
+    for (int d=0; d<cp.nextDelay; ++d) trial = stepSim(trial, false, objs);
+    for (int delay=cp.nextDelay; delay<=cp.maxDelay; ++delay) {
+        if (delay > cp.nextDelay) trial = stepSim(trial, false, objs);
+        if (isDead(trial)) break;
+        if (!trial.onGround) continue;
+        SimState after = stepSim(trial, true, objs);
+        if (isDead(after) || !horizonSurvives(after, cp.frame + delay + 1, objs, info, goalX, dead)) continue;
+        cp.nextDelay = delay + 1;
+        outJumps.push_back(cp.frame + delay);
+        state = after;
+        frame = cp.frame + delay + 1;
+        return true;
+    }
+    cp.nextDelay = cp.maxDelay + 1;
+    return false;
+}
+
+// Depth-first variant of runPathfinder: its first line is greedy's (adaptive horizon, no
+// memo), and when no jump works at a decision point it rewinds to the most recent earlier
+// decision - a takeoff delay or a grounded frame it coasted through - and tries its next
+// alternative.
+static bool runBacktracking(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    outJumps.clear();
+    std::ostringstream rep;
+    rep << "Backtracking run\n";
+    rep << "Objects: " << objs.size() << "\n";
+    CheckpointRing stack;
+    NogoodCache dead;
+    HorizonInfo info(objs);
+    SimState state = start;
+    int frame = 0;
+    int decisions = 0, backtracks = 0;
+    auto finish = [&](bool ok) {
+        rep << "Decisions: " << decisions << ", backtracks: " << backtracks
+            << ", checkpoints dropped: " << stack.dropped << "\n";
+        rep << "Nogood cache: " << dead.used << " states, " << dead.hits << " hits / " << dead.lookups << " lookups\n";
+        report = rep.str();
+        return ok;
+    };
+    while (frame < MAX_FRAMES) {
+        if (state.px >= goalX) {
+            rep << "Success at frame " << frame << "\n";
+            for (int f : outJumps) rep << "Jump at frame " << f << "\n";
+            return finish(true);
         }
-        // compute bounding
-        float minX = INFINITY, maxX = -INFINITY, groundY = -INFINITY;
-        for (auto &o : objs) {
-            minX = std::min(minX, o.r.x);
-            maxX = std::max(maxX, o.r.x + o.r.w);
-            if (o.type == ObjType::PLATFORM) groundY = std::max(groundY, o.r.y + o.r.h);
-        }
-        if (!std::isfinite(minX)) minX = 0.0f;
-        if (!std::isfinite(maxX)) maxX = minX + 1200.0f;
-        if (!std::isfinite(groundY)) groundY = 0.0f;
-        SimState start;
-        start.px = minX - START_BEFORE_X;
-        start.py = groundY + 12.0f;
-        start.vx = PLAYER_SPEED; start.vy = 0.0f; start.onGround = true;
-        std::vector<int> jumps;
-        std::string report;
-        bool okPlan = runPathfinder(objs, start, maxX, jumps, report);
-        // write report and macro
-        auto reportPath = (Mod::get()->getSaveDir() / "pathfinder_report.txt");
-        try {
-            std::ofstream rf(reportPath.string(), std::ios::trunc);
-            rf << "extraction debug:\\n" << dbg << "\\n";
-            rf << report << "\\n";
-            rf << "objects:\\n";
-            for (auto &o : objs) {
-                rf << (o.type==ObjType::PLATFORM?\"PLATFORM\":o.type==ObjType::SPIKE?\"SPIKE\":\"JUMP_PAD\") << \",\"
-                   << o.r.x << \",\" << o.r.y << \",\" << o.r.w << \",\" << o.r.h << \"\\n\";
-            }
-            rf.close();
-        } catch(...) {
-            GEODE_ERROR(\"[Pathfinder] failed to write report file\");
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped at frame " << frame << "\n";
+            return finish(false);
         }
-        if (!okPlan) {
-            geode::Notification::create(\"Pathfinder: couldn't find safe macro. See pathfinder_report.txt\", geode::NotificationIcon::Exclamation, 6.0f)->show();
-            return;
+        if (horizonSurvives(state, frame, objs, info, goalX, dead)) {
+            if (state.onGround) stack.push({state, frame, 0, 0, (int)outJumps.size()});
+            state = stepSim(state, false, objs);
+            ++frame;
+            continue;
         }
-        try {
-            auto macroPath = (Mod::get()->getSaveDir() / \"macro.txt\").string();
-            std::ofstream mf(macroPath, std::ios::trunc);
-            for (auto f : jumps) mf << f << \"\\n\";
-            mf.close();
-            std::ostringstream msg;
-            msg << \"Pathfinder: wrote macro.txt (\" << jumps.size() << \" jumps) and pathfinder_report.txt\";
-            geode::Notification::create(msg.str(), geode::NotificationIcon::Check, 6.0f)->show();
-            GEODE_INFO(\"[Pathfinder] wrote macro: %s\", macroPath.c_str());
-        } catch(...) {
-            geode::Notification::create(\"Pathfinder: failed to write macro.txt\", geode::NotificationIcon::Exclamation, 6.0f)->show();
+        ++decisions;
+        stack.push({state, frame, 0, std::max(MAX_DELAY, adaptiveHorizon(state, info)), (int)outJumps.size()});
+        bool resolved = false;
+        while (!stack.empty()) {
+            Checkpoint& cp = stack.peek();
+            outJumps.resize(cp.jumpCount);
+            if (takeNextAlternative(cp, objs, info, goalX, state, frame, outJumps, dead)) { resolved = true; break; }
+            int failedAt = cp.frame;
+            stack.pop();
+            if (++backtracks > BT_MAX_BACKTRACKS) {
+                rep << "Failed: backtrack limit reached at frame " << failedAt << "\n";
+                return finish(false);
+            }
         }
+        if (!resolved) {
+            rep << "Failed at frame " << frame << "\n";
+            return finish(false);
+        }
+    }
+    rep << "Failed: max frames exceeded\n";
+    return finish(false);
+}
+
+// Replay a macro from start and check it reaches goalX alive. failFrame is the frame of
+// death (or MAX_FRAMES) when it does not; reachedX, if given, gets the furthest live px.
+static bool verifyMacro(const std::vector<Obj>& objs, SimState start, float goalX, const std::vector<int>& jumps, int& failFrame, float* reachedX = nullptr, int maxFrames = MAX_FRAMES) {
+    SimState state = start;
+    size_t next = 0;
+    for (int frame=0; frame<maxFrames; ++frame) {
+        if (reachedX) *reachedX = state.px;
+        if (state.px >= goalX) return true;
+        bool jump = false;
+        while (next < jumps.size() && jumps[next] <= frame) jump |= (jumps[next++] == frame);
+        state = stepSim(state, jump, objs);
+        if (isDead(state)) { failFrame = frame; return false; }
     }
+    failFrame = maxFrames;
+    return false;
+}
+
+// One press of the jump button, down for frames [press, release). stepSim jumps on every
+// grounded frame the button is down, so holding through a landing jumps again right away
+// (a buffered jump): the outcome of a hold depends only on how many takeoffs it chains,
+// not on where in the last flight it is released.
+struct Hold {
+    int press, release;
 };
 
-class $modify(MenuLayer) {
-    void onMoreGames(CCObject* sender) {
-        MenuLayer::onMoreGames(sender);
-        try {
-            PathfinderPopup p;
-            p.show();
-        } catch(...) {
-            GEODE_ERROR(\"[Pathfinder] exception showing popup\");
+// Jump frames to presses: a takeoff with no grounded frame since the previous one extends
+// that press instead of starting a new one.
+static std::vector<Hold> holdsFromJumps(const std::vector<Obj>& objs, SimState start, const std::vector<int>& jumps) {
+    std::vector<Hold> holds;
+    SimState state = start;
+    bool groundedSince = true;   // a grounded frame since the last takeoff
+    size_t next = 0;
+    for (int frame=0; next < jumps.size() && frame < MAX_FRAMES; ++frame) {
+        const bool jump = jumps[next] == frame;
+        if (jump) {
+            if (!holds.empty() && !groundedSince) holds.back().release = frame + 1;
+            else holds.push_back({frame, frame + 1});
+            groundedSince = false;
+            ++next;
+        } else if (state.onGround) {
+            groundedSince = true;
         }
+        state = stepSim(state, jump, objs);
+        if (isDead(state)) break;
+    }
+    return holds;
+}
+
+// The frames a sequence of presses actually takes off on.
+static std::vector<int> jumpsFromHolds(const std::vector<Obj>& objs, SimState start, float goalX, const std::vector<Hold>& holds) {
+    std::vector<int> jumps;
+    SimState state = start;
+    size_t next = 0;
+    for (int frame=0; next < holds.size() && frame < MAX_FRAMES && state.px < goalX; ++frame) {
+        while (next < holds.size() && holds[next].release <= frame) ++next;
+        const bool down = next < holds.size() && holds[next].press <= frame;
+        if (down && state.onGround) jumps.push_back(frame);
+        state = stepSim(state, down, objs);
+        if (isDead(state)) break;
+    }
+    return jumps;
+}
+
+// macro.txt: one press per line, "frame" for a tap or "press release" for a hold.
+static void writeMacro(std::ostream& out, const std::vector<Hold>& holds) {
+    for (const Hold& h : holds) {
+        if (h.release == h.press + 1) out << h.press << "\n";
+        else out << h.press << " " << h.release << "\n";
     }
+}
+
+// Point where the player is known to be running on flat ground: at frame `frame` the
+// state is exactly {x, top, vy=0, onGround}, whatever happened before it.
+struct Seam {
+    int frame;
+    SimState state;
 };
+
+// Find stretches of ground that nothing else overlaps horizontally and that are long
+// enough for any earlier jump to have landed and settled, and place seams on them.
+static std::vector<Seam> findSeams(const std::vector<Obj>& objs, SimState start, float goalX) {
+    struct Event { float x; int delta; int idx; };
+    std::vector<Event> events;
+    events.reserve(objs.size() * 2);
+    for (int i=0; i<(int)objs.size(); ++i) {
+        events.push_back({objs[i].r.x, +1, i});
+        events.push_back({objs[i].r.x + objs[i].r.w, -1, i});
+    }
+    std::sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.x != b.x ? a.x < b.x : a.delta < b.delta;
+    });
+
+    // clear stretches: maximal x ranges covered by exactly one platform, merged across
+    // abutting platforms with the same top
+    struct Stretch { float x0, x1, top; };
+    std::vector<Stretch> stretches;
+    std::set<int> active;
+    for (size_t e=0; e<events.size(); ++e) {
+        if (events[e].delta > 0) active.insert(events[e].idx); else active.erase(events[e].idx);
+        if (e + 1 == events.size() || active.size() != 1) continue;
+        const Obj& o = objs[*active.begin()];
+        float x0 = events[e].x, x1 = events[e+1].x;
+        if (o.type != ObjType::PLATFORM || x1 <= x0) continue;
+        float top = o.r.y + o.r.h;
+        if (!stretches.empty() && std::fabs(stretches.back().x1 - x0) < 1e-3f && std::fabs(stretches.back().top - top) < 1e-3f)
+            stretches.back().x1 = x1;
+        else
+            stretches.push_back({x0, x1, top});
+    }
+
+    // a full jump plus the longest greedy probe (and so the latest delayed takeoff) of flat
+    // running before the seam, and the longest probe after it so nothing past the seam
+    // can trigger a jump before it
+    const float airFrames = 2.0f * JUMP_VELOCITY / -GRAVITY / FRAME_DT;
+    const float settle = (airFrames + HORIZON_MAX) * PLAYER_SPEED * FRAME_DT;
+    const float clearAfter = (HORIZON_MAX + 1) * PLAYER_SPEED * FRAME_DT;
+    std::vector<Seam> seams;
+    float lastX = start.px;
+    int frame = 0;
+    float px = start.px;
+    for (auto const& st : stretches) {
+        float seamX = st.x0 + settle;
+        if (seamX + clearAfter >= st.x1 || seamX >= goalX || seamX - lastX < SEAM_MIN_SEGMENT) continue;
+        // accumulate px exactly as stepSim does so the seam state matches a full replay
+        while (px < seamX && frame < MAX_FRAMES) { px += PLAYER_SPEED * FRAME_DT; ++frame; }
+        if (px + clearAfter > st.x1) continue;
+        Seam sm;
+        sm.frame = frame;
+        sm.state.px = px; sm.state.py = st.top;
+        sm.state.vx = PLAYER_SPEED; sm.state.vy = 0.0f; sm.state.onGround = true;
+        seams.push_back(sm);
+        lastX = px;
+    }
+    return seams;
+}
+
+// Solve the level as independent segments split at seams, then stitch the jump lists and
+// verify the whole macro. Segments are spread over the cores only when ctl grants spare
+// ones (speculativeWorkers); a solve from a pool works through them on its own thread.
+// Falls back to runPathfinder when there are no seams or the stitched macro does not replay.
+static bool runSegmentParallel(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    std::vector<Seam> seams = findSeams(objs, start, goalX);
+    if (seams.empty()) return runPathfinder(objs, start, goalX, outJumps, report, ctl);
+
+    struct Segment {
+        Seam from;
+        float goal;
+        bool ok = false;
+        std::vector<int> jumps;
+        std::string report;
+    };
+    std::vector<Segment> segs(seams.size() + 1);
+    segs[0].from = {0, start};
+    for (size_t i=0; i<seams.size(); ++i) {
+        segs[i].goal = seams[i].state.px;
+        segs[i+1].from = seams[i];
+    }
+    segs.back().goal = goalX;
+
+    std::atomic<size_t> nextSeg{0};
+    auto worker = [&]() {
+        for (size_t i = nextSeg++; i < segs.size(); i = nextSeg++) {
+            Segment& sg = segs[i];
+            sg.ok = runPathfinderWith(objs, sg.from.state, sg.goal, sg.jumps, sg.report, ctl, 0);   // threads are busy with segments
+            if (!sg.ok) {
+                std::string btReport;
+                sg.ok = runBacktracking(objs, sg.from.state, sg.goal, sg.jumps, btReport, ctl);
+                sg.report += btReport;
+            }
+        }
+    };
+    size_t nThreads = ctl && ctl->speculativeWorkers > 0 ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+    nThreads = std::min(nThreads, segs.size());
+    std::vector<std::thread> pool;
+    for (size_t t=1; t<nThreads; ++t) pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool) th.join();
+
+    std::ostringstream rep;
+    rep << "Segment-parallel run\n";
+    rep << "Segments: " << segs.size() << ", threads: " << nThreads << "\n";
+    outJumps.clear();
+    bool allOk = true;
+    for (auto const& sg : segs) {
+        rep << "-- segment from frame " << sg.from.frame << " (x=" << sg.from.state.px << ")\n" << sg.report;
+        if (!sg.ok) { allOk = false; break; }
+        for (int f : sg.jumps) outJumps.push_back(sg.from.frame + f);
+    }
+    int failFrame = 0;
+    if (allOk && verifyMacro(objs, start, goalX, outJumps, failFrame)) {
+        rep << "Stitched macro verified\n";
+        report = rep.str();
+        return true;
+    }
+    if (allOk) rep << "Stitched macro failed verification at frame " << failFrame << "\n";
+    rep << "Falling back to sequential solve\n";
+    std::string seqReport;
+    bool ok = runPathfinder(objs, start, goalX, outJumps, seqReport, ctl);
+    report = rep.str() + seqReport;
+    return ok;
+}
+
+// Horizontal run of platform tops at one height, merged across abutting platforms.
+// Ground contacts on it are numbered node0 + (frame - firstFrame).
+struct Surface {
+    float x0, x1, top;
+    int firstFrame = 0, frames = 0, node0 = 0;
+};
+
+static std::vector<Surface> buildSurfaces(const std::vector<Obj>& objs) {
+    std::vector<Surface> out;
+    for (auto const& o : objs) {
+        if (o.type == ObjType::PLATFORM) out.push_back({o.r.x, o.r.x + o.r.w, o.r.y + o.r.h});
+    }
+    std::sort(out.begin(), out.end(), [](const Surface& a, const Surface& b) {
+        return a.top != b.top ? a.top < b.top : a.x0 < b.x0;
+    });
+    std::vector<Surface> merged;
+    for (auto const& sf : out) {
+        if (!merged.empty() && merged.back().top == sf.top && sf.x0 <= merged.back().x1 + 1e-3f)
+            merged.back().x1 = std::max(merged.back().x1, sf.x1);
+        else
+            merged.push_back(sf);
+    }
+    return merged;
+}
+
+// Solve on a graph of ground contacts instead of frame by frame. px depends only on the
+// frame, so two grounded states on the same surface at the same frame are identical and
+// the input only matters while grounded: each contact has a coast edge and a jump edge,
+// each validated by one stepSim sweep to the next contact. All edges go forward in time,
+// so one backward pass gives solvability (and the fewest jumps) from every contact.
+static bool runContactGraph(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    outJumps.clear();
+    std::ostringstream rep;
+    rep << "Contact graph run\n";
+    rep << "Objects: " << objs.size() << "\n";
+
+    // px at each frame, accumulated exactly as stepSim does
+    std::vector<float> pxAt;
+    for (float px = start.px; (int)pxAt.size() < MAX_FRAMES; px += PLAYER_SPEED * FRAME_DT) {
+        pxAt.push_back(px);
+        if (px >= goalX) break;
+    }
+    const int lastFrame = (int)pxAt.size() - 1;
+
+    std::vector<Surface> surfaces = buildSurfaces(objs);
+    int nodeCount = 0;
+    for (auto& sf : surfaces) {
+        auto lo = std::lower_bound(pxAt.begin(), pxAt.end(), sf.x0);
+        auto hi = std::upper_bound(pxAt.begin(), pxAt.end(), sf.x1);
+        sf.firstFrame = (int)(lo - pxAt.begin());
+        sf.frames = (int)(hi - lo);
+        sf.node0 = nodeCount;
+        nodeCount += sf.frames;
+    }
+    const int GOAL = -1, DEAD = -2;
+    auto contactAt = [&](const SimState& st, int frame) {
+        for (auto const& sf : surfaces) {
+            if (sf.top == st.py && frame >= sf.firstFrame && frame < sf.firstFrame + sf.frames)
+                return sf.node0 + (frame - sf.firstFrame);
+        }
+        return DEAD;
+    };
+    // run from a state at `frame` (jumping on the first step if asked) to the next contact
+    auto sweep = [&](SimState st, int frame, bool jump) {
+        for (; frame < MAX_FRAMES; ++frame) {
+            if (st.px >= goalX) return GOAL;
+            st = stepSim(st, jump, objs);
+            jump = false;
+            if (isDead(st)) return DEAD;
+            if (st.onGround) return contactAt(st, frame + 1);
+        }
+        return DEAD;
+    };
+
+    // nodes in decreasing frame order so every successor is resolved first
+    std::vector<int> nodeFrame(nodeCount), nodeSurface(nodeCount), order(nodeCount);
+    for (int si=0; si<(int)surfaces.size(); ++si) {
+        for (int k=0; k<surfaces[si].frames; ++k) {
+            nodeFrame[surfaces[si].node0 + k] = surfaces[si].firstFrame + k;
+            nodeSurface[surfaces[si].node0 + k] = si;
+        }
+    }
+    for (int i=0; i<nodeCount; ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return nodeFrame[a] > nodeFrame[b]; });
+
+    const int UNSOLVABLE = INT_MAX;
+    std::vector<int> cost(nodeCount, UNSOLVABLE), next(nodeCount, DEAD);
+    std::vector<char> jumpEdge(nodeCount, 0);
+    auto costOf = [&](int target) { return target == GOAL ? 0 : target == DEAD ? UNSOLVABLE : cost[target]; };
+    int sweeps = 0;
+    for (int n : order) {
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped with " << sweeps / 2 << " of " << nodeCount << " contacts resolved\n";
+            report = rep.str();
+            return false;
+        }
+        int frame = nodeFrame[n];
+        SimState g;
+        g.px = pxAt[frame]; g.py = surfaces[nodeSurface[n]].top;
+        g.vx = PLAYER_SPEED; g.vy = 0.0f; g.onGround = true;
+        if (frame >= lastFrame) { cost[n] = 0; next[n] = GOAL; continue; }
+        int coast = sweep(g, frame, false);
+        int jump = sweep(g, frame, true);
+        sweeps += 2;
+        int cc = costOf(coast), jc = costOf(jump);
+        if (jc != UNSOLVABLE && jc + 1 < cc) { cost[n] = jc + 1; next[n] = jump; jumpEdge[n] = 1; }
+        else if (cc != UNSOLVABLE) { cost[n] = cc; next[n] = coast; }
+    }
+    int solvable = 0;
+    for (int c : cost) solvable += (c != UNSOLVABLE);
+    rep << "Surfaces: " << surfaces.size() << ", ground contacts: " << nodeCount
+        << ", solvable from: " << solvable << ", sweeps: " << sweeps << "\n";
+
+    // the start state is usually airborne; its first contact (or its jump) enters the graph
+    int entry = sweep(start, 0, false);
+    bool entryJump = false;
+    if (start.onGround) {
+        int j = sweep(start, 0, true);
+        if (costOf(j) != UNSOLVABLE && (costOf(entry) == UNSOLVABLE || costOf(j) + 1 < costOf(entry))) {
+            entry = j;
+            entryJump = true;
+        }
+    }
+    if (costOf(entry) == UNSOLVABLE) {
+        rep << "Failed: no path from start\n";
+        report = rep.str();
+        return false;
+    }
+    if (entryJump) outJumps.push_back(0);
+    for (int n = entry; n >= 0; n = next[n]) {
+        if (jumpEdge[n]) {
+            outJumps.push_back(nodeFrame[n]);
+            rep << "Jump at frame " << nodeFrame[n] << "\n";
+        }
+    }
+    rep << "Success with " << outJumps.size() << " jumps\n";
+    report = rep.str();
+    return true;
+}
+
+// Reachability lattice over (y, vy). Units are chosen so free flight is exact integer
+// motion: V counts |GRAVITY|*dt/K and Y counts V*dt, so each frame a cell drops K rows and
+// moves by its new V in Y bins. Every row is a bitset over Y, so one frame advances every
+// reachable state (i.e. every input sequence) with a few shifted word ORs. K=2 makes
+// JUMP_VELOCITY a whole number of rows.
+static uint64_t latticeMask(int word, int lo, int hi) {
+    int a = std::max(lo - word * 64, 0), b = std::min(hi - word * 64, 63);
+    if (a > b) return 0;
+    uint64_t m = (b == 63) ? ~0ull : ((1ull << (b + 1)) - 1);
+    return m & ~((1ull << a) - 1);
+}
+
+// dst |= src shifted towards higher Y by `shift` bins (negative shifts go down)
+static void latticeOrShifted(uint64_t* dst, const uint64_t* src, int words, int shift) {
+    int ws = (shift >= 0 ? shift : -shift) / 64, bs = (shift >= 0 ? shift : -shift) % 64;
+    if (shift >= 0) {
+        for (int i=words-1; i>=ws; --i) {
+            uint64_t v = src[i - ws] << bs;
+            if (bs && i - ws - 1 >= 0) v |= src[i - ws - 1] >> (64 - bs);
+            dst[i] |= v;
+        }
+    } else {
+        for (int i=0; i+ws<words; ++i) {
+            uint64_t v = src[i + ws] >> bs;
+            if (bs && i + ws + 1 < words) v |= src[i + ws + 1] << (64 - bs);
+            dst[i] |= v;
+        }
+    }
+}
+
+// clear bins lo..hi, returning the lowest bin that was set (or -1)
+static int latticeTake(uint64_t* row, int lo, int hi) {
+    int first = -1;
+    for (int w = lo / 64; w <= hi / 64; ++w) {
+        uint64_t m = row[w] & latticeMask(w, lo, hi);
+        if (m && first < 0) first = w * 64 + __builtin_ctzll(m);
+        row[w] &= ~m;
+    }
+    return first;
+}
+
+static bool latticeAny(const uint64_t* row, int words) {
+    uint64_t acc = 0;
+    for (int i=0; i<words; ++i) acc |= row[i];
+    return acc != 0;
+}
+
+// A lattice cell; ground cells have V == 0 and may jump.
+struct LatticeCell {
+    int v, y;
+    bool ground;
+    bool operator==(const LatticeCell& o) const { return v == o.v && y == o.y && ground == o.ground; }
+};
+
+// Back-pointer recorded where several cells merge into one (landing, pad launch): the
+// merged cell at some frame came from `pred`, a post-move cell of the same frame.
+struct LatticeEvent {
+    LatticeCell cell, pred;
+};
+
+// Propagate the reachable lattice frame by frame from start and answer whether the goal
+// can be reached by any input sequence. Free flight is invertible, so the only
+// back-pointers kept are the ground cells per frame (the jump frames) and the merge
+// events; a path is rebuilt backwards from them and replayed through stepSim. The level
+// only counts as solvable once that replay reaches the goal; a quantized path that does
+// not rebuild or diverges from stepSim, or a stopped run, sets `inconclusive` instead.
+static bool runLatticeReach(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr, bool* inconclusive = nullptr) {
+    outJumps.clear();
+    if (inconclusive) *inconclusive = false;
+    std::ostringstream rep;
+    rep << "Lattice reachability run\n";
+    const int K = LATTICE_SUBDIV;
+    const float vRes = -GRAVITY * FRAME_DT / K;
+    const float yRes = vRes * FRAME_DT;
+    auto toY = [&](float y) { return (int)std::lround(y / yRes); };
+    auto toV = [&](float vy) { return (int)std::lround(vy / vRes); };
+
+    // cells below the lowest platform top can never land again and are dropped
+    int yLo = INT_MAX, yTop = toY(start.py), vHi = std::max(toV(JUMP_VELOCITY), toV(start.vy));
+    for (auto const& o : objs) {
+        if (o.type == ObjType::PLATFORM) { yLo = std::min(yLo, toY(o.r.y + o.r.h)); yTop = std::max(yTop, toY(o.r.y + o.r.h)); }
+        if (o.type == ObjType::JUMP_PAD) { yTop = std::max(yTop, toY(o.r.y + o.r.h)); vHi = std::max(vHi, toV(o.power > 0.0f ? o.power : JUMP_VELOCITY)); }
+    }
+    if (yLo == INT_MAX || toY(start.py) < yLo) {
+        rep << "Failed: start is below every platform\n";
+        report = rep.str();
+        return false;
+    }
+    // one frame of the fastest fall below the lowest top, so cells can still land on it
+    const int span = yTop - yLo + vHi * (vHi + K) / (2 * K) + 2;
+    const int vMin = -(int)std::ceil(std::sqrt(2.0 * K * span)) - 2 * K, vMax = vHi + K;
+    const int floorY = -vMin;
+    yLo -= floorY;
+    const int ny = span + floorY;
+    const int words = (ny + 63) / 64;
+    const int rows = vMax - vMin + 1;
+    const int vJump = toV(JUMP_VELOCITY);
+    rep << "Lattice: " << rows << " vy rows x " << ny << " y bins (" << words << " words/row)\n";
+
+    std::vector<uint64_t> cur((size_t)rows * words), nxt((size_t)rows * words), ground(words), nground(words);
+    auto row = [&](std::vector<uint64_t>& b, int v) { return b.data() + (size_t)(v - vMin) * words; };
+    auto set = [](uint64_t* r, int y) { r[y / 64] |= 1ull << (y % 64); };
+    auto test = [](const uint64_t* r, int y) { return (r[y / 64] >> (y % 64)) & 1; };
+    LatticeCell startCell{toV(start.vy), toY(start.py) - yLo, start.onGround && toV(start.vy) == 0};
+    if (startCell.ground) set(ground.data(), startCell.y); else set(row(cur, startCell.v), startCell.y);
+
+    std::vector<int> groundOff{0}, groundY, eventOff{0};
+    std::vector<LatticeEvent> events;
+    for (int y=0; y<ny; ++y) if (test(ground.data(), y)) groundY.push_back(y);
+    groundOff.push_back((int)groundY.size());
+
+    std::vector<int> byX(objs.size()), active;
+    for (size_t i=0; i<objs.size(); ++i) byX[i] = (int)i;
+    std::sort(byX.begin(), byX.end(), [&](int a, int b) { return objs[a].r.x < objs[b].r.x; });
+    size_t nextObj = 0;
+    std::vector<int> tops;
+
+    float px = start.px;
+    int frame = 0;
+    bool reached = px >= goalX, alive = true;
+    while (!reached && alive && frame < MAX_FRAMES) {
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped at frame " << frame << "\n";
+            report = rep.str();
+            if (inconclusive) *inconclusive = true;
+            return false;
+        }
+        px += PLAYER_SPEED * FRAME_DT;
+        while (nextObj < byX.size() && objs[byX[nextObj]].r.x <= px) active.push_back(byX[nextObj++]);
+        active.erase(std::remove_if(active.begin(), active.end(), [&](int i) { return objs[i].r.x + objs[i].r.w < px; }), active.end());
+
+        std::fill(nxt.begin(), nxt.end(), 0);
+        std::fill(nground.begin(), nground.end(), 0);
+        for (int v=vMin+K; v<=vMax; ++v) {
+            if (latticeAny(row(cur, v), words)) latticeOrShifted(row(nxt, v - K), row(cur, v), words, v - K);
+        }
+        latticeOrShifted(row(nxt, -K), ground.data(), words, -K);
+        latticeOrShifted(row(nxt, vJump - K), ground.data(), words, vJump - K);
+
+        // landing: highest top first, as stepSim picks the best top
+        tops.clear();
+        for (int i : active) if (objs[i].type == ObjType::PLATFORM) tops.push_back(toY(objs[i].r.y + objs[i].r.h) - yLo);
+        std::sort(tops.rbegin(), tops.rend());
+        tops.erase(std::unique(tops.begin(), tops.end()), tops.end());
+        for (int t : tops) {
+            if (t < 0 || t >= ny) continue;
+            for (int v=vMin; v<=0; ++v) {
+                int y = latticeTake(row(nxt, v), std::max(t + v, 0), t);
+                if (y < 0) continue;
+                if (!test(nground.data(), t)) events.push_back({{0, t, true}, {v, y, false}});
+                set(nground.data(), t);
+            }
+        }
+        for (int v=vMin; v<=vMax; ++v) latticeTake(row(nxt, v), 0, floorY - 1);
+        for (int i : active) {
+            const Obj& o = objs[i];
+            if (o.type != ObjType::JUMP_PAD) continue;
+            int lo = std::max(toY(o.r.y) - yLo, 0), hi = std::min(toY(o.r.y + o.r.h) - yLo, ny - 1);
+            int vp = toV(o.power > 0.0f ? o.power : JUMP_VELOCITY);
+            if (lo > hi) continue;
+            for (int y=lo; y<=hi; ++y) {
+                LatticeCell from{0, y, true};
+                bool hit = test(nground.data(), y);
+                for (int v=vMin; v<=vMax && !hit; ++v) {
+                    if (v != vp && test(row(nxt, v), y)) { from = {v, y, false}; hit = true; }
+                }
+                if (!hit) continue;
+                events.push_back({{vp, y, false}, from});
+                set(row(nxt, vp), y);
+            }
+            latticeTake(nground.data(), lo, hi);
+            for (int v=vMin; v<=vMax; ++v) if (v != vp) latticeTake(row(nxt, v), lo, hi);
+        }
+        for (int i : active) {
+            const Obj& o = objs[i];
+            if (o.type != ObjType::SPIKE) continue;
+            int lo = std::max((int)std::ceil(o.r.y / yRes) - yLo, 0);
+            int hi = std::min((int)std::floor((o.r.y + o.r.h) / yRes) - yLo, ny - 1);
+            if (lo > hi) continue;
+            latticeTake(nground.data(), lo, hi);
+            for (int v=vMin; v<=vMax; ++v) latticeTake(row(nxt, v), lo, hi);
+        }
+
+        std::swap(cur, nxt);
+        std::swap(ground, nground);
+        ++frame;
+        for (int y=0; y<ny; ++y) if (test(ground.data(), y)) groundY.push_back(y);
+        groundOff.push_back((int)groundY.size());
+        eventOff.push_back((int)events.size());
+        alive = latticeAny(ground.data(), words) || latticeAny(cur.data(), (int)cur.size());
+        reached = alive && px >= goalX;
+    }
+    rep << "Frames propagated: " << frame << ", merge events: " << events.size() << "\n";
+    if (!reached) {
+        rep << (alive ? "Unsolvable: max frames exceeded\n" : "Unsolvable: no reachable state after frame ") << (alive ? "" : std::to_string(frame - 1) + "\n");
+        report = rep.str();
+        return false;
+    }
+    rep << "Goal cell reached at frame " << frame << "\n";
+
+    // walk back from any surviving cell, inverting free flight between merge events
+    LatticeCell cell{0, -1, true};
+    for (int y=0; y<ny && cell.y < 0; ++y) if (test(ground.data(), y)) cell = {0, y, true};
+    for (int v=vMin; v<=vMax && cell.y < 0; ++v) {
+        for (int y=0; y<ny; ++y) if (test(row(cur, v), y)) { cell = {v, y, false}; break; }
+    }
+    auto findEvent = [&](int f, const LatticeCell& c) -> const LatticeEvent* {
+        for (int i=eventOff[f - 1]; i<eventOff[f]; ++i) if (events[i].cell == c) return &events[i];
+        return nullptr;
+    };
+    auto groundAt = [&](int f, int y) {
+        return std::binary_search(groundY.begin() + groundOff[f], groundY.begin() + groundOff[f + 1], y);
+    };
+    bool consistent = true;
+    for (int f=frame; f>0 && consistent; --f) {
+        if (const LatticeEvent* ev = !cell.ground ? findEvent(f, cell) : nullptr) cell = ev->pred;
+        if (cell.ground) {
+            const LatticeEvent* ev = findEvent(f, cell);
+            if (!ev) { consistent = false; break; }
+            cell = ev->pred;
+        }
+        if (cell.v == -K && groundAt(f - 1, cell.y + K)) {
+            cell = {0, cell.y + K, true};
+        } else if (cell.v == vJump - K && groundAt(f - 1, cell.y - cell.v)) {
+            outJumps.push_back(f - 1);
+            cell = {0, cell.y - cell.v, true};
+        } else {
+            cell = {cell.v + K, cell.y - cell.v, false};
+            if (cell.v > vMax || cell.y < 0 || cell.y >= ny) consistent = false;
+        }
+    }
+    std::reverse(outJumps.begin(), outJumps.end());
+    if (!consistent || !(cell == startCell)) {
+        rep << "Inconclusive: path reconstruction failed\n";
+        report = rep.str();
+        if (inconclusive) *inconclusive = true;
+        return false;
+    }
+    int failFrame = 0;
+    if (!verifyMacro(objs, start, goalX, outJumps, failFrame)) {
+        rep << "Inconclusive: lattice path (" << outJumps.size() << " jumps) diverges from stepSim at frame " << failFrame << " (quantization)\n";
+        report = rep.str();
+        if (inconclusive) *inconclusive = true;
+        return false;
+    }
+    rep << "Solvable: lattice path (" << outJumps.size() << " jumps) verified with stepSim\n";
+    report = rep.str();
+    return true;
+}
+
+// Legal takeoff delays from a grounded state, worked out with interval algebra on the jump
+// arc instead of probing each delay. The arc and the px sequence are stepped with the same
+// float operations as stepSim, so for a flight that only lands and hits spikes the
+// windows are exact; a flight that touches a pad is left to simulation (`unsure`).
+struct JumpWindows {
+    int coastLimit = 0;       // last delay at which the player is still on this ground
+    bool coastDies = false;   // one more frame of coasting hits a spike (else edge, pad or horizon)
+    int flight = 0;           // frames of the jump arc until nothing is left to land on
+    std::vector<float> pxs;   // px after each frame from the state, coastLimit + flight + 1 entries
+    std::vector<std::pair<int, int>> legal;   // disjoint delay intervals, ascending
+    std::vector<int> unsure;                  // delays whose flight touches a pad
+};
+
+static JumpWindows jumpWindows(const SimState& s, const std::vector<Obj>& objs, const HorizonInfo& info, float goalX) {
+    JumpWindows w;
+    const float y0 = s.py;
+    std::vector<float> arc(1, y0);
+    const float floorY = std::isfinite(info.lowestTop) ? info.lowestTop - 1.0f : -1000.0f;
+    for (float vy = JUMP_VELOCITY, y = y0; y >= floorY && (int)arc.size() <= HORIZON_MAX;) {
+        vy += GRAVITY * FRAME_DT;
+        y += vy * FRAME_DT;
+        arc.push_back(y);
+    }
+    w.flight = (int)arc.size() - 1;
+    w.pxs.assign(1, s.px);
+    auto extend = [&](int m) { while ((int)w.pxs.size() <= m) w.pxs.push_back(w.pxs.back() + PLAYER_SPEED * FRAME_DT); };
+
+    // coasting: stays on this ground until an edge, a step to another top, a pad or a spike
+    const float coastY = y0 + GRAVITY * FRAME_DT * FRAME_DT;
+    w.coastLimit = HORIZON_MAX;
+    for (int m=1; m<=HORIZON_MAX; ++m) {
+        extend(m);
+        const float x = w.pxs[m];
+        float top = -INFINITY;
+        bool pad = false, spike = false;
+        info.forEachOverlapping(objs, x, x, [&](const Obj& o) {
+            if (x < o.r.x || x > o.r.x + o.r.w) return;
+            const float t = o.r.y + o.r.h;
+            if (o.type == ObjType::PLATFORM && y0 >= t - 1e-3f && coastY <= t + 1e-3f) top = std::max(top, t);
+            else if (o.type == ObjType::JUMP_PAD && o.r.contains(x, y0)) pad = true;
+            else if (o.type == ObjType::SPIKE && o.r.contains(x, y0)) spike = true;
+        });
+        if (top != y0 || pad || spike) {
+            w.coastLimit = m - 1;
+            w.coastDies = spike && top == y0 && !pad;
+            break;
+        }
+    }
+    const int D = w.coastLimit, N = w.flight;
+    extend(D + N);
+    const std::vector<float>& pxs = w.pxs;
+    auto firstAt = [&](float x) { return (int)(std::lower_bound(pxs.begin(), pxs.end(), x) - pxs.begin()); };
+    auto lastAt = [&](float x) { return (int)(std::upper_bound(pxs.begin(), pxs.end(), x) - pxs.begin()) - 1; };
+
+    // first landing step per delay; a platform is landed on at the arc steps that cross its
+    // top going down, for the delays that put those steps over it
+    std::vector<int> land(D + 1, INT_MAX);
+    std::vector<float> landTop(D + 1, -INFINITY);
+    struct Band { int n1, n2, mA, mB; const Obj* o; };
+    std::vector<Band> spikes, pads;
+    info.forEachOverlapping(objs, pxs[1], pxs[D + N], [&](const Obj& o) {
+        const int mA = firstAt(o.r.x), mB = lastAt(o.r.x + o.r.w);
+        if (mA > mB) return;
+        if (o.type == ObjType::PLATFORM) {
+            const float t = o.r.y + o.r.h;
+            for (int n=1; n<=N; ++n) {
+                if (!(arc[n - 1] >= t - 1e-3f && arc[n] <= t + 1e-3f)) continue;
+                for (int d=std::max(0, mA - n); d<=std::min(D, mB - n); ++d) {
+                    if (n < land[d] || (n == land[d] && t > landTop[d])) { land[d] = n; landTop[d] = t; }
+                }
+            }
+            return;
+        }
+        // arc steps inside the object's height, as runs (at most two for a parabola)
+        std::vector<Band>& out = o.type == ObjType::SPIKE ? spikes : pads;
+        for (int n=1; n<=N; ++n) {
+            if (arc[n] < o.r.y || arc[n] > o.r.y + o.r.h) continue;
+            int n2 = n;
+            while (n2 + 1 <= N && arc[n2 + 1] >= o.r.y && arc[n2 + 1] <= o.r.y + o.r.h) ++n2;
+            out.push_back({n, n2, mA, mB, &o});
+            n = n2;
+        }
+    });
+
+    // a delay is legal if the flight lands (or reaches the goal) before any spike
+    std::vector<char> ok(D + 1, 0);
+    for (int d=0; d<=D; ++d) {
+        int end = land[d];
+        if (end == INT_MAX) {
+            if (pxs[d + N] < goalX) continue;   // falls with nothing below
+            end = firstAt(goalX) - d;
+        }
+        bool hit = false, pad = false;
+        for (const Band& b : spikes) hit = hit || std::max(b.n1, b.mA - d) <= std::min({b.n2, b.mB - d, end - 1});
+        for (const Band& b : pads) pad = pad || std::max(b.n1, b.mA - d) <= std::min({b.n2, b.mB - d, end});
+        if (land[d] != INT_MAX) {
+            // the landing step is checked at the top it snapped to
+            const float x = pxs[d + end];
+            for (const Band& b : spikes) hit = hit || (b.o->type == ObjType::SPIKE && b.o->r.contains(x, landTop[d]));
+        }
+        if (hit) continue;
+        if (pad) { w.unsure.push_back(d); continue; }
+        ok[d] = 1;
+    }
+    for (int d=0; d<=D; ++d) {
+        if (!ok[d]) continue;
+        if (!w.legal.empty() && w.legal.back().second == d - 1) w.legal.back().second = d;
+        else w.legal.push_back({d, d});
+    }
+    return w;
+}
+
+// Planner on jump windows: coast (analytically) to within one flight of where the ground
+// ends, then take the latest legal takeoff whose flight stepSim confirms and whose landing
+// still has a way on, backing up to earlier decisions when none does. Airborne frames are
+// simply stepped - nothing can be done in the air.
+static bool runIntervalSolver(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    outJumps.clear();
+    std::ostringstream rep;
+    rep << "Interval solver run\n";
+    rep << "Objects: " << objs.size() << "\n";
+    HorizonInfo info(objs);
+    SimState state = start;
+    int frame = 0;
+    long long decisions = 0, confirms = 0, backtracks = 0;
+    // a decision with its takeoff options, most promising first, for backtracking
+    struct IntervalChoice {
+        SimState state;
+        int frame;
+        size_t jumps;
+        std::vector<int> order;
+        size_t next;
+        bool walk;
+        JumpWindows w;
+    };
+    std::vector<IntervalChoice> stack;
+    auto done = [&](bool ok) {
+        rep << "Decisions: " << decisions << ", backtracks: " << backtracks << ", stepSim confirmations: " << confirms << "\n";
+        report = rep.str();
+        return ok;
+    };
+    // stepSim from s at frame f, jumping at jumpAt (if >= f), until it stands again, dies
+    // or reaches the goal
+    auto fly = [&](SimState s, int f, int jumpAt, int& outFrame) {
+        ++confirms;
+        const int limit = f + 2 * HORIZON_MAX;
+        do {
+            s = stepSim(s, f == jumpAt, objs);
+            ++f;
+        } while (!s.onGround && !isDead(s) && s.px < goalX && f < limit);
+        outFrame = f;
+        return s;
+    };
+    auto viable = [&](const SimState& s) {
+        if (isDead(s)) return false;
+        if (s.px >= goalX || !s.onGround) return true;
+        JumpWindows w = jumpWindows(s, objs, info, goalX);
+        return !w.coastDies || !w.legal.empty() || !w.unsure.empty();
+    };
+    while (frame < MAX_FRAMES) {
+        if (state.px >= goalX) {
+            rep << "Success at frame " << frame << "\n";
+            return done(true);
+        }
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped at frame " << frame << "\n";
+            return done(false);
+        }
+        if (!state.onGround) {
+            state = stepSim(state, false, objs);
+            ++frame;
+            if (isDead(state)) {
+                rep << "Died in the air at frame " << frame << "\n";
+                return done(false);
+            }
+            continue;
+        }
+        JumpWindows w = jumpWindows(state, objs, info, goalX);
+        // takeoffs more than a flight before the end of this ground land on it again
+        const int skip = w.coastLimit - w.flight - 1;
+        if (skip > 0) {
+            int m = 0;
+            while (m < skip && w.pxs[m] < goalX) ++m;
+            state.px = w.pxs[m];
+            frame += m;
+            continue;
+        }
+        ++decisions;
+        IntervalChoice c{state, frame, outJumps.size(), {}, 0, !w.coastDies, std::move(w)};
+        for (auto it = c.w.legal.rbegin(); it != c.w.legal.rend(); ++it)
+            for (int d=it->second; d>=it->first; --d) c.order.push_back(d);
+        c.order.insert(c.order.end(), c.w.unsure.begin(), c.w.unsure.end());
+        stack.push_back(std::move(c));
+        // take the next untried option, going back to earlier decisions when one runs out
+        bool moved = false;
+        while (!moved && !stack.empty()) {
+            IntervalChoice& top = stack.back();
+            outJumps.resize(top.jumps);
+            SimState s = top.state;
+            int f = top.frame;
+            if (top.walk) {
+                // walking on (off an edge, onto a pad or another top) needs no input
+                top.walk = false;
+                for (int m=0; m<=top.w.coastLimit; ++m, ++f) s = stepSim(s, false, objs);
+                if (!s.onGround && !isDead(s) && s.px < goalX) s = fly(s, f, -1, f);
+                moved = viable(s);
+            } else if (top.next < top.order.size()) {
+                const int d = top.order[top.next++];
+                s.px = top.w.pxs[d];
+                s = fly(s, f + d, f + d, f);
+                moved = viable(s);
+                if (moved) {
+                    outJumps.push_back(top.frame + d);
+                    rep << "Jump at frame " << top.frame + d << " (legal:";
+                    for (auto const& iv : top.w.legal) rep << " " << top.frame + iv.first << "-" << top.frame + iv.second;
+                    rep << ")\n";
+                }
+            } else {
+                rep << "No legal takeoff at frame " << top.frame << " (ground ends at frame " << top.frame + top.w.coastLimit << ")\n";
+                stack.pop_back();
+                if (++backtracks > BT_MAX_BACKTRACKS) break;
+                continue;
+            }
+            if (moved) { state = s; frame = f; }
+        }
+        if (!moved) {
+            rep << "Out of options\n";
+            return done(false);
+        }
+    }
+    rep << "Failed: max frames exceeded\n";
+    return done(false);
+}
+
+// Touching or overlapping platforms (and spikes) with the same y and height, as one rect.
+// stepSim only asks whether px lies in some rect of a kind, so the merged level steps like
+// the original with far fewer objects - a tiled floor becomes one platform.
+static std::vector<Obj> mergeGeometry(const std::vector<Obj>& objs) {
+    std::vector<Obj> out, runs;
+    for (const Obj& o : objs) (o.type == ObjType::PLATFORM || o.type == ObjType::SPIKE ? runs : out).push_back(o);
+    std::sort(runs.begin(), runs.end(), [](const Obj& a, const Obj& b) {
+        return std::make_tuple((int)a.type, a.r.y, a.r.h, a.r.x) < std::make_tuple((int)b.type, b.r.y, b.r.h, b.r.x);
+    });
+    const size_t kept = out.size();
+    for (const Obj& o : runs) {
+        if (out.size() > kept) {
+            Obj& b = out.back();
+            if (b.type == o.type && b.r.y == o.r.y && b.r.h == o.r.h && o.r.x <= b.r.x + b.r.w) {
+                b.r.w = std::max(b.r.x + b.r.w, o.r.x + o.r.w) - b.r.x;
+                continue;
+            }
+        }
+        out.push_back(o);
+    }
+    return out;
+}
+
+// Coarse-to-fine planner on the merged geometry. A greedy pass that only decides every
+// COARSE_STEP frames lays out the jumps; where it gets stuck, the coarse jumps of the last
+// REFINE_BACK frames are dropped and that stretch, up to REFINE_AHEAD frames past the
+// failure, is replanned at full frame resolution. The coarse pass then resumes. Last, a
+// full-resolution greedy pass that decides only within COARSE_STEP frames of a coarse
+// jump places every jump exactly; the coarse jumps stand if that pass fails.
+static bool runCoarseToFine(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    outJumps.clear();
+    std::ostringstream rep;
+    rep << "Coarse-to-fine run\n";
+    const std::vector<Obj> merged = mergeGeometry(objs);
+    rep << "Objects: " << objs.size() << " (" << merged.size() << " merged)\n";
+    GreedyOptions coarse;
+    coarse.probeMemo = false;
+    coarse.patterns = false;
+    coarse.speculate = true;
+    coarse.granularity = COARSE_STEP;
+    GreedyOptions fine = coarse;
+    fine.granularity = 1;
+    // the state `frames` frames after s with `jumps` (relative frames) pressed
+    auto replay = [&](SimState s, const std::vector<int>& jumps, int frames) {
+        size_t next = 0;
+        for (int f=0; f<frames; ++f) {
+            const bool jump = next < jumps.size() && jumps[next] == f;
+            next += jump;
+            s = stepSim(s, jump, merged);
+        }
+        return s;
+    };
+    SimState state = start;
+    int frame = 0;
+    long long coarseFrames = 0, fineFrames = 0;
+    int refinements = 0;
+    for (;;) {
+        if (ctl && ctl->stopped()) {
+            rep << "Stopped at frame " << frame << "\n";
+            report = rep.str();
+            return false;
+        }
+        std::vector<int> jumps;
+        std::string passReport;
+        GreedyStats st;
+        if (runGreedy(merged, state, goalX, jumps, passReport, ctl, coarse, &st)) {
+            for (int j : jumps) outJumps.push_back(frame + j);
+            coarseFrames += st.endFrame;
+            break;
+        }
+        if (ctl && ctl->stopped()) continue;
+        // keep the coarse plan up to one flight before it got stuck
+        const int from = std::max(0, st.endFrame - REFINE_BACK);
+        std::vector<int> kept;
+        for (int j : jumps) if (j < from) kept.push_back(j);
+        for (int j : kept) outJumps.push_back(frame + j);
+        coarseFrames += from;
+        const SimState mid = replay(state, kept, from);
+        float localGoal = mid.px;
+        for (int f=from; f<st.endFrame + REFINE_AHEAD; ++f) localGoal += PLAYER_SPEED * FRAME_DT;
+        localGoal = std::min(localGoal, goalX);
+        std::vector<int> fineJumps;
+        GreedyStats fs;
+        if (!runGreedy(merged, mid, localGoal, fineJumps, passReport, ctl, fine, &fs)) {
+            rep << "Refinement failed at frame " << frame + from + fs.endFrame << "\n";
+            report = rep.str();
+            return false;
+        }
+        ++refinements;
+        rep << "Refined frames " << frame + from << "-" << frame + from + fs.endFrame << " (coarse pass stuck at " << frame + st.endFrame << ")\n";
+        for (int j : fineJumps) outJumps.push_back(frame + from + j);
+        fineFrames += fs.endFrame;
+        state = replay(mid, fineJumps, fs.endFrame);
+        frame += from + fs.endFrame;
+        if (state.px >= goalX) break;
+    }
+    rep << "Frames decided coarse: " << coarseFrames << ", at full resolution: " << fineFrames << " (" << refinements << " refinements)\n";
+    const std::vector<int> coarseJumps = outJumps;
+    GreedyOptions windowed = fine;
+    windowed.windows = &coarseJumps;
+    windowed.windowRadius = COARSE_STEP;
+    std::vector<int> refined;
+    std::string passReport;
+    GreedyStats ws;
+    int failFrame = 0;
+    if (runGreedy(merged, start, goalX, refined, passReport, ctl, windowed, &ws) && verifyMacro(objs, start, goalX, refined, failFrame)) {
+        int moved = 0;
+        for (int j : refined) moved += !std::binary_search(coarseJumps.begin(), coarseJumps.end(), j);
+        rep << "Jumps placed at full resolution: " << moved << " of " << refined.size() << " moved off the coarse plan\n";
+        outJumps = std::move(refined);
+    } else {
+        rep << "Full-resolution placement failed at frame " << ws.endFrame << "; keeping the coarse jumps\n";
+    }
+    const bool ok = verifyMacro(objs, start, goalX, outJumps, failFrame);
+    if (ok) rep << "Success, verified on the original geometry\n";
+    else rep << "Plan does not replay on the original geometry (frame " << failFrame << ")\n";
+    report = rep.str();
+    return ok;
+}
+
+using Solver = bool (*)(const std::vector<Obj>&, SimState, float, std::vector<int>&, std::string&, const SolveControl*);
+
+// Strategies raced by runPortfolio; on a tie the earlier one wins.
+static const std::pair<const char*, Solver> PORTFOLIO[] = {
+    {"intervals", runIntervalSolver},
+    {"greedy", [](const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& jumps, std::string& report, const SolveControl* ctl) {
+        return runPathfinderWith(objs, start, goalX, jumps, report, ctl, 0);   // the race already uses the cores
+    }},
+    {"contact graph", runContactGraph},
+    {"backtracking", runBacktracking},
+};
+
+// Portfolio wins per strategy over the life of the process, to tune the mix from.
+struct PortfolioStats {
+    std::mutex m;
+    std::map<std::string, int> wins;
+    int races = 0;
+    static PortfolioStats& get() { static PortfolioStats stats; return stats; }
+};
+
+// Race the PORTFOLIO strategies on one thread each over the shared level. The first macro
+// that verifies is taken and the rest are cancelled through their SolveControl, which also
+// follows the caller's.
+static bool runPortfolio(const std::vector<Obj>& objs, SimState start, float goalX, std::vector<int>& outJumps, std::string& report, const SolveControl* ctl = nullptr) {
+    struct Entry {
+        SolveControl ctl;
+        std::vector<int> jumps;
+        std::string report;
+        bool ok = false;
+        bool done = false;
+        double ms = 0.0;
+    };
+    const int n = (int)(sizeof(PORTFOLIO) / sizeof(PORTFOLIO[0]));
+    std::vector<Entry> entries(n);
+    std::mutex m;
+    std::condition_variable cv;
+    int winner = -1, running = n;
+    auto cancelAll = [&]() { for (Entry& e : entries) e.ctl.cancelled = true; };
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int i=0; i<n; ++i) {
+        if (ctl) entries[i].ctl.deadline = ctl->deadline;
+        pool.emplace_back([&, i]() {
+            Entry& e = entries[i];
+            bool ok = PORTFOLIO[i].second(objs, start, goalX, e.jumps, e.report, &e.ctl);
+            int failFrame = 0;
+            ok = ok && verifyMacro(objs, start, goalX, e.jumps, failFrame);
+            std::lock_guard<std::mutex> lock(m);
+            e.ok = ok;
+            e.done = true;
+            e.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (ok && winner < 0) {
+                winner = i;
+                cancelAll();
+            }
+            --running;
+            cv.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(m);
+        while (winner < 0 && running > 0) {
+            cv.wait_for(lock, std::chrono::milliseconds(20));
+            if (ctl && ctl->stopped()) cancelAll();
+        }
+    }
+    for (auto& t : pool) t.join();
+
+    std::ostringstream rep;
+    rep << "Portfolio run (" << n << " strategies)\n";
+    for (int i=0; i<n; ++i) {
+        const Entry& e = entries[i];
+        rep << "  " << std::left << std::setw(14) << PORTFOLIO[i].first << std::right
+            << (i == winner ? "won" : e.ok ? "verified, too late" : e.ctl.cancelled ? "cancelled" : "failed")
+            << " after " << std::fixed << std::setprecision(1) << e.ms << " ms\n";
+    }
+    {
+        PortfolioStats& stats = PortfolioStats::get();
+        std::lock_guard<std::mutex> lock(stats.m);
+        ++stats.races;
+        if (winner >= 0) ++stats.wins[PORTFOLIO[winner].first];
+    }
+    if (winner < 0) {
+        // hand on the partial macro that gets furthest, as a lone solver would
+        int furthest = -1;
+        float bestX = -INFINITY;
+        for (int i=0; i<n; ++i) {
+            int failFrame = 0;
+            float reachedX = start.px;
+            verifyMacro(objs, start, goalX, entries[i].jumps, failFrame, &reachedX);
+            if (reachedX > bestX) bestX = reachedX, furthest = i;
+        }
+        rep << "No strategy produced a verified macro; furthest: " << PORTFOLIO[furthest].first << "\n" << entries[furthest].report;
+        outJumps = entries[furthest].jumps;
+        report = rep.str();
+        return false;
+    }
+    rep << "Portfolio winner: " << PORTFOLIO[winner].first << "\n" << entries[winner].report;
+    outJumps = entries[winner].jumps;
+    report = rep.str();
+    return true;
+}
+
+// Best macro found so far by an anytime solve. Incomplete macros are ranked by how far
+// they get before dying.
+struct AnytimeResult {
+    std::vector<int> jumps;
+    std::vector<Hold> holds;   // the same input as button presses, for macro.txt
+    float reachedX = -INFINITY;
+    bool complete = false;
+    bool finished = false;
+    std::string stage = "none";
+    std::string report;
+};
+
+// Runs increasingly strong solvers on a background thread until one completes the level
+// or the budget runs out: greedy first, then the interval solver, coarse-to-fine, the
+// segment-parallel solve, the contact graph and backtracking. A lone solve, which is given
+// spare cores through speculativeWorkers, races the contact graph and backtracking in
+// runPortfolio instead, before the segment-parallel solve. Greedy first runs under
+// ANYTIME_FIRST_STAGE and publishes the prefix it committed, so waitFirst has a macro
+// within ANYTIME_FIRST_ANSWER however large the level; unless that already completes it,
+// greedy is run again in full before escalating. Callers can take the current best at
+// any time.
+class AnytimeSolver {
+public:
+    using FinishCallback = std::function<void(const AnytimeResult&)>;
+
+    // onFinish runs on the worker thread once the solve is complete or out of budget.
+    // speculativeWorkers is for a lone solve; solves from a pool leave it 0.
+    static std::shared_ptr<AnytimeSolver> start(std::vector<Obj> objs, SimState start, float goalX,
+                                                std::chrono::milliseconds budget, FinishCallback onFinish, int speculativeWorkers = 0) {
+        auto solver = std::shared_ptr<AnytimeSolver>(new AnytimeSolver());
+        solver->ctl.deadline = std::chrono::steady_clock::now() + budget;
+        solver->ctl.speculativeWorkers = speculativeWorkers;
+        std::thread([solver, objs = std::move(objs), start, goalX, onFinish]() {
+            solver->work(objs, start, goalX);
+            if (onFinish) onFinish(solver->best());
+        }).detach();
+        return solver;
+    }
+
+    // wait until the first stage has reported (or the solve finished), at most `timeout`
+    AnytimeResult waitFirst(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, timeout, [&] { return result.stage != "none" || result.finished; });
+        return result;
+    }
+    AnytimeResult waitFinished() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return result.finished; });
+        return result;
+    }
+    AnytimeResult best() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return result;
+    }
+    void cancel() { ctl.cancelled = true; }
+
+private:
+    AnytimeSolver() = default;
+
+    // `frames` bounds the replay, so a prefix is only credited as far as its planner got
+    void offer(const char* stage, const std::vector<Obj>& objs, SimState start, float goalX,
+               const std::vector<int>& jumps, const std::string& report, int frames = MAX_FRAMES) {
+        int failFrame = 0;
+        float reachedX = start.px;
+        bool complete = verifyMacro(objs, start, goalX, jumps, failFrame, &reachedX, frames);
+        std::vector<Hold> holds = holdsFromJumps(objs, start, jumps);
+        std::lock_guard<std::mutex> lock(mutex);
+        result.report += report + "\n";
+        bool better = complete ? !result.complete : (!result.complete && reachedX > result.reachedX);
+        if (better || result.stage == "none") {
+            result.jumps = jumps;
+            result.holds = std::move(holds);
+            result.reachedX = reachedX;
+            result.complete = complete;
+            result.stage = stage;
+        }
+        cv.notify_all();
+    }
+
+    void work(const std::vector<Obj>& objs, SimState start, float goalX) {
+        // the first answer: greedy under a deadline of its own, credited only up to the
+        // frame it stopped at. The planner steps every committed frame itself, so the
+        // replay costs at most twice its run. cancel() lands after the first stage.
+        SolveControl first;
+        first.cancelled = ctl.cancelled.load();
+        first.deadline = std::min(ctl.deadline, std::chrono::steady_clock::now() + ANYTIME_FIRST_STAGE);
+        {
+            GreedyOptions opt;
+            opt.speculate = true;
+            opt.workers = ctl.speculativeWorkers;
+            GreedyStats stats;
+            std::vector<int> jumps;
+            std::string report;
+            runGreedy(objs, start, goalX, jumps, report, &first, opt, &stats);
+            offer("greedy", objs, start, goalX, jumps, report, stats.endFrame + 1);
+        }
+        std::vector<std::pair<const char*, Solver>> stages;
+        stages = {{"greedy", runPathfinder}, {"intervals", runIntervalSolver}, {"coarse-to-fine", runCoarseToFine}};
+        if (ctl.speculativeWorkers > 0) stages.insert(stages.end(), {{"portfolio", runPortfolio}, {"segments", runSegmentParallel}});
+        else stages.insert(stages.end(), {{"segments", runSegmentParallel}, {"contact graph", runContactGraph}, {"backtracking", runBacktracking}});
+        for (auto const& st : stages) {
+            if (best().complete) break;
+            if (ctl.stopped()) break;
+            std::vector<int> jumps;
+            std::string report;
+            st.second(objs, start, goalX, jumps, report, &ctl);
+            offer(st.first, objs, start, goalX, jumps, report);
+        }
+        // solvability from the lattice, to compare the planners against; a lattice path
+        // that does not replay through stepSim is reported but not compared
+        if (!ctl.stopped()) {
+            std::vector<int> latticeJumps;
+            std::string latticeReport;
+            bool inconclusive = false;
+            bool solvable = runLatticeReach(objs, start, goalX, latticeJumps, latticeReport, &ctl, &inconclusive);
+            std::lock_guard<std::mutex> lock(mutex);
+            result.report += latticeReport;
+            if (!inconclusive && solvable != result.complete)
+                result.report += std::string("Planner ") + (result.complete ? "solved" : "failed") + " but lattice says " + (solvable ? "solvable" : "unsolvable") + "\n";
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        result.report += "Anytime: best from " + result.stage + (result.complete ? " (complete)" : " (partial)")
+                       + (ctl.stopped() ? ", budget expired\n" : "\n");
+        result.finished = true;
+        cv.notify_all();
+    }
+
+    SolveControl ctl;
+    std::mutex mutex;
+    std::condition_variable cv;
+    AnytimeResult result;
+};
+
+// Player start just before the first object, dropping onto the highest platform top, and
+// the goal just past the last object.
+static SimState levelStart(const std::vector<Obj>& objs, float& goalX) {
+    float minX = INFINITY, maxX = -INFINITY, groundY = -INFINITY;
+    for (auto &o : objs) {
+        minX = std::min(minX, o.r.x);
+        maxX = std::max(maxX, o.r.x + o.r.w);
+        if (o.type == ObjType::PLATFORM) groundY = std::max(groundY, o.r.y + o.r.h);
+    }
+    if (!std::isfinite(minX)) minX = 0.0f;
+    if (!std::isfinite(maxX)) maxX = minX + 1200.0f;
+    if (!std::isfinite(groundY)) groundY = 0.0f;
+    SimState start;
+    start.px = minX - START_BEFORE_X;
+    start.py = groundY + 12.0f;
+    start.vx = PLAYER_SPEED; start.vy = 0.0f; start.onGround = true;
+    goalX = maxX;
+    return start;
+}
+
+// level.txt parsing. The file is mapped and tokenized in place; failures come back as a
+// code and a line number instead of exceptions.
+enum class ParseError { NONE, OPEN_FAILED, MISSING_FIELD, BAD_NUMBER, BAD_BINARY, BAD_BASE64, BAD_DEFLATE, PATTERN_LIBRARY, LEVEL_PACK };
+
+struct ParseResult {
+    ParseError error = ParseError::NONE;
+    int line = 0;       // line of the error
+    int ignored = 0;    // lines with an unknown object type
+};
+
+static const char* parseErrorName(ParseError e) {
+    switch (e) {
+        case ParseError::NONE: return "ok";
+        case ParseError::OPEN_FAILED: return "file not found";
+        case ParseError::MISSING_FIELD: return "missing field";
+        case ParseError::BAD_NUMBER: return "bad number";
+        case ParseError::BAD_BINARY: return "truncated or unsupported binary level";
+        case ParseError::BAD_BASE64: return "bad base64";
+        case ParseError::BAD_DEFLATE: return "corrupt compressed level data";
+        case ParseError::PATTERN_LIBRARY: return "pattern library, not a level (pass it with --patterns)";
+        case ParseError::LEVEL_PACK: return "level pack, not a level (use import or batch)";
+    }
+    return "?";
+}
+
+static std::string_view trimView(std::string_view s) {
+    const size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string_view::npos) return {};
+    return s.substr(a, s.find_last_not_of(" \t\r\n") - a + 1);
+}
+
+// Floating-point from_chars where the standard library has it; the libc++ of the Android
+// NDK and older Apple SDKs does not, and there strtof reads a NUL-terminated copy.
+static bool parseFloat(std::string_view s, float& v) {
+    if (!s.empty() && s[0] == '+') s.remove_prefix(1);   // from_chars takes no leading '+'
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    const char* end = s.data() + s.size();
+    auto [ptr, ec] = std::from_chars(s.data(), end, v);
+    return ec == std::errc() && ptr == end && !s.empty();
+#else
+    char buf[64];
+    if (s.empty() || s.size() >= sizeof(buf) || std::isspace((unsigned char)s[0])) return false;
+    std::memcpy(buf, s.data(), s.size());
+    buf[s.size()] = '\0';
+    char* end = nullptr;
+    errno = 0;
+    v = std::strtof(buf, &end);
+    return errno != ERANGE && end == buf + s.size();
+#endif
+}
+
+static bool sameWord(std::string_view tok, std::string_view upper) {
+    if (tok.size() != upper.size()) return false;
+    for (size_t i=0; i<tok.size(); ++i)
+        if (toupper((unsigned char)tok[i]) != upper[i]) return false;
+    return true;
+}
+
+static ParseResult parseLevelText(std::string_view text, std::vector<Obj>& out) {
+    out.clear();
+    out.reserve(text.size() / 24);   // a typical line is 20-30 bytes
+    ParseResult res;
+    int ln = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string_view::npos) nl = text.size();
+        const std::string_view line = trimView(text.substr(pos, nl - pos));
+        pos = nl + 1;
+        ++ln;
+        if (line.empty() || line[0] == '#') continue;
+        std::string_view toks[5];
+        size_t n = 0, from = 0;
+        while (n < 5) {
+            const size_t comma = line.find(',', from);
+            toks[n++] = trimView(line.substr(from, comma == std::string_view::npos ? std::string_view::npos : comma - from));
+            if (comma == std::string_view::npos) break;
+            from = comma + 1;
+        }
+        Obj o;
+        auto fail = [&](ParseError e) { res.error = e; res.line = ln; return res; };
+        if (sameWord(toks[0], "PLATFORM") || sameWord(toks[0], "SPIKE")) {
+            if (n < 5) return fail(ParseError::MISSING_FIELD);
+            o.type = sameWord(toks[0], "SPIKE") ? ObjType::SPIKE : ObjType::PLATFORM;
+            if (!parseFloat(toks[1], o.r.x) || !parseFloat(toks[2], o.r.y) || !parseFloat(toks[3], o.r.w) || !parseFloat(toks[4], o.r.h))
+                return fail(ParseError::BAD_NUMBER);
+        } else if (sameWord(toks[0], "JUMP_PAD")) {
+            if (n < 4) return fail(ParseError::MISSING_FIELD);
+            o.type = ObjType::JUMP_PAD;
+            o.r.h = 16.0f;
+            o.power = JUMP_VELOCITY;
+            if (!parseFloat(toks[1], o.r.x) || !parseFloat(toks[2], o.r.y) || !parseFloat(toks[3], o.r.w) || (n >= 5 && !parseFloat(toks[4], o.power)))
+                return fail(ParseError::BAD_NUMBER);
+        } else {
+            ++res.ignored;
+            continue;
+        }
+        out.push_back(o);
+    }
+    return res;
+}
+
+// parseLevelText over several threads: the text is cut at line boundaries into one chunk
+// per thread, the chunks are parsed concurrently, and their objects are copied into place
+// at offsets from a prefix sum of the chunk counts, so the result is the same as a serial
+// parse. Below PARSE_CHUNK_MIN bytes per thread it parses serially.
+static ParseResult parseLevelTextParallel(std::string_view text, std::vector<Obj>& out, int threads = 0) {
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    threads = (int)std::min<size_t>((size_t)threads, text.size() / PARSE_CHUNK_MIN);
+    if (threads <= 1) return parseLevelText(text, out);
+    std::vector<size_t> cuts(threads + 1, text.size());
+    cuts[0] = 0;
+    for (int i=1; i<threads; ++i) {
+        const size_t nl = text.find('\n', text.size() / threads * i);
+        cuts[i] = std::max(cuts[i-1], nl == std::string_view::npos ? text.size() : nl + 1);
+    }
+    struct Chunk { std::vector<Obj> objs; ParseResult res; };
+    std::vector<Chunk> chunks(threads);
+    std::vector<size_t> at(threads + 1, 0);
+    auto inParallel = [threads](const std::function<void(int)>& fn) {
+        std::vector<std::thread> pool;
+        for (int i=1; i<threads; ++i) pool.emplace_back(fn, i);
+        fn(0);
+        for (auto& th : pool) th.join();
+    };
+    inParallel([&](int i) { chunks[i].res = parseLevelText(text.substr(cuts[i], cuts[i+1] - cuts[i]), chunks[i].objs); });
+    ParseResult res;
+    for (int i=0; i<threads; ++i) {
+        if (chunks[i].res.error != ParseError::NONE) {
+            // the first error in file order, numbered from the top of the file
+            res = chunks[i].res;
+            res.line += (int)std::count(text.begin(), text.begin() + cuts[i], '\n');
+            out.clear();
+            return res;
+        }
+        res.ignored += chunks[i].res.ignored;
+        at[i+1] = at[i] + chunks[i].objs.size();
+    }
+    out.resize(at[threads]);
+    inParallel([&](int i) { std::copy(chunks[i].objs.begin(), chunks[i].objs.end(), out.begin() + at[i]); });
+    return res;
+}
+
+// Binary level (.pfl): a LevelFileHeader, then the platform rects, the spike rects and the
+// pads, each array packed back to back. Every field is 4 bytes, so the arrays are read
+// straight out of the mapping.
+struct LevelPad {
+    Rect r;
+    float power;
+};
+
+struct LevelFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t platforms, spikes, pads;
+    Rect bounds;        // union of all object rects
+};
+static constexpr char LEVEL_MAGIC[4] = {'P', 'F', 'L', 'V'};
+static constexpr char PACK_MAGIC[4] = {'P', 'F', 'P', 'K'};   // level pack, see PackHeader
+static constexpr uint32_t LEVEL_VERSION = 1;
+
+// The error for files of ours that hold no single level, or NONE.
+static ParseError notALevel(std::string_view bytes) {
+    if (bytes.size() < 4) return ParseError::NONE;
+    if (std::memcmp(bytes.data(), PATTERN_MAGIC, 4) == 0) return ParseError::PATTERN_LIBRARY;
+    if (std::memcmp(bytes.data(), PACK_MAGIC, 4) == 0) return ParseError::LEVEL_PACK;
+    return ParseError::NONE;
+}
+
+static bool isBinaryLevel(std::string_view bytes) {
+    return bytes.size() >= sizeof(LEVEL_MAGIC) && std::memcmp(bytes.data(), LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) == 0;
+}
+
+static ParseResult loadBinaryLevel(std::string_view bytes, std::vector<Obj>& out) {
+    out.clear();
+    ParseResult res;
+    LevelFileHeader hdr;
+    if (bytes.size() < sizeof(hdr)) { res.error = ParseError::BAD_BINARY; return res; }
+    std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+    const size_t need = sizeof(hdr) + ((size_t)hdr.platforms + hdr.spikes) * sizeof(Rect) + (size_t)hdr.pads * sizeof(LevelPad);
+    if (hdr.version != LEVEL_VERSION || bytes.size() < need) { res.error = ParseError::BAD_BINARY; return res; }
+    const Rect* platforms = reinterpret_cast<const Rect*>(bytes.data() + sizeof(hdr));
+    const Rect* spikes = platforms + hdr.platforms;
+    const LevelPad* pads = reinterpret_cast<const LevelPad*>(spikes + hdr.spikes);
+    out.resize((size_t)hdr.platforms + hdr.spikes + hdr.pads);
+    Obj* o = out.data();
+    for (uint32_t i=0; i<hdr.platforms; ++i, ++o) { o->type = ObjType::PLATFORM; o->r = platforms[i]; }
+    for (uint32_t i=0; i<hdr.spikes; ++i, ++o) { o->type = ObjType::SPIKE; o->r = spikes[i]; }
+    for (uint32_t i=0; i<hdr.pads; ++i, ++o) { o->type = ObjType::JUMP_PAD; o->r = pads[i].r; o->power = pads[i].power; }
+    return res;
+}
+
+// Writes objs as a binary level; objects of unknown type are dropped.
+static bool saveBinaryLevel(const std::filesystem::path& p, const std::vector<Obj>& objs, std::string& err) {
+    std::vector<Rect> platforms, spikes;
+    std::vector<LevelPad> pads;
+    LevelFileHeader hdr{};
+    std::memcpy(hdr.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    hdr.version = LEVEL_VERSION;
+    float x0 = INFINITY, y0 = INFINITY, x1 = -INFINITY, y1 = -INFINITY;
+    for (const Obj& o : objs) {
+        if (o.type == ObjType::PLATFORM) platforms.push_back(o.r);
+        else if (o.type == ObjType::SPIKE) spikes.push_back(o.r);
+        else if (o.type == ObjType::JUMP_PAD) pads.push_back({o.r, o.power});
+        else continue;
+        x0 = std::min(x0, o.r.x); y0 = std::min(y0, o.r.y);
+        x1 = std::max(x1, o.r.x + o.r.w); y1 = std::max(y1, o.r.y + o.r.h);
+    }
+    // sorted by x so the level can be streamed
+    auto byX = [](const Rect& a, const Rect& b) { return a.x < b.x; };
+    std::stable_sort(platforms.begin(), platforms.end(), byX);
+    std::stable_sort(spikes.begin(), spikes.end(), byX);
+    std::stable_sort(pads.begin(), pads.end(), [](const LevelPad& a, const LevelPad& b) { return a.r.x < b.r.x; });
+    hdr.platforms = (uint32_t)platforms.size();
+    hdr.spikes = (uint32_t)spikes.size();
+    hdr.pads = (uint32_t)pads.size();
+    if (x0 <= x1) hdr.bounds = {x0, y0, x1 - x0, y1 - y0};
+    std::ofstream f(p, std::ios::binary | std::ios::trunc);
+    f.write((const char*)&hdr, sizeof(hdr));
+    f.write((const char*)platforms.data(), (std::streamsize)(platforms.size() * sizeof(Rect)));
+    f.write((const char*)spikes.data(), (std::streamsize)(spikes.size() * sizeof(Rect)));
+    f.write((const char*)pads.data(), (std::streamsize)(pads.size() * sizeof(LevelPad)));
+    if (!f) { err = "cannot write " + p.string(); return false; }
+    return true;
+}
+
+// GD's own level string: URL-safe base64 of gzip (or zlib) compressed text, whose
+// ';'-separated sections are the level settings followed by one object each, written as
+// alternating key,value fields (1 = object ID, 2 = x, 3 = y, 4/5 = flip X/Y, 6 = rotation,
+// 32 = scale). Flipping X only mirrors an object about its centre, which its rect does
+// not see, so key 4 is not read.
+
+// URL-safe base64 alphabet; the standard '+' and '/' are accepted too. 0x80 marks bytes
+// outside the alphabet.
+static constexpr std::array<uint8_t, 256> BASE64_VALUES = [] {
+    std::array<uint8_t, 256> t{};
+    for (auto& v : t) v = 0x80;
+    const char* abc = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+    for (int i=0; i<62; ++i) t[(uint8_t)abc[i]] = (uint8_t)i;
+    t['-'] = t['+'] = 62;
+    t['_'] = t['/'] = 63;
+    return t;
+}();
+
+// Decodes into out (resized to fit); trailing '=' padding is optional.
+static bool decodeBase64(std::string_view in, std::vector<uint8_t>& out) {
+    while (!in.empty() && in.back() == '=') in.remove_suffix(1);
+    out.resize(in.size() / 4 * 3 + 3);
+    const uint8_t* s = (const uint8_t*)in.data();
+    uint8_t* d = out.data();
+    size_t i = 0;
+    for (; i + 4 <= in.size(); i += 4, d += 3) {
+        const uint32_t a = BASE64_VALUES[s[i]], b = BASE64_VALUES[s[i+1]], c = BASE64_VALUES[s[i+2]], e = BASE64_VALUES[s[i+3]];
+        if ((a | b | c | e) & 0x80) return false;
+        const uint32_t v = a << 18 | b << 12 | c << 6 | e;
+        d[0] = (uint8_t)(v >> 16); d[1] = (uint8_t)(v >> 8); d[2] = (uint8_t)v;
+    }
+    const size_t rest = in.size() - i;
+    if (rest == 1) return false;
+    if (rest > 1) {
+        uint32_t v = 0;
+        for (size_t k=0; k<rest; ++k) {
+            const uint32_t x = BASE64_VALUES[s[i+k]];
+            if (x & 0x80) return false;
+            v |= x << (18 - 6 * k);
+        }
+        *d++ = (uint8_t)(v >> 16);
+        if (rest == 3) *d++ = (uint8_t)(v >> 8);
+    }
+    out.resize(d - out.data());
+    return true;
+}
+
+// Canonical Huffman code (RFC 1951 3.2.2). Codes up to INFLATE_FAST_BITS long resolve
+// with one table lookup, longer ones bit by bit through count/symbol.
+struct HuffmanCode {
+    uint16_t fast[1 << INFLATE_FAST_BITS];   // (length << 9) | symbol, 0 for longer codes
+    uint16_t count[16];
+    uint16_t symbol[288];
+
+    bool build(const uint8_t* lengths, int n) {
+        std::memset(fast, 0, sizeof(fast));
+        std::memset(count, 0, sizeof(count));
+        for (int i=0; i<n; ++i) ++count[lengths[i]];
+        count[0] = 0;
+        int left = 1;
+        for (int len=1; len<16; ++len) {
+            left = left * 2 - count[len];
+            if (left < 0) return false;   // over-subscribed
+        }
+        uint16_t offs[16], next[16];
+        offs[1] = 0;
+        next[1] = 0;
+        for (int len=1; len<15; ++len) {
+            offs[len+1] = offs[len] + count[len];
+            next[len+1] = (uint16_t)((next[len] + count[len]) << 1);
+        }
+        for (int sym=0; sym<n; ++sym) {
+            const int len = lengths[sym];
+            if (len == 0) continue;
+            symbol[offs[len]++] = (uint16_t)sym;
+            if (len > INFLATE_FAST_BITS) continue;
+            uint32_t code = next[len]++, rev = 0;
+            for (int k=0; k<len; ++k) { rev = rev << 1 | (code & 1); code >>= 1; }
+            for (uint32_t i=rev; i<(1u << INFLATE_FAST_BITS); i += 1u << len) fast[i] = (uint16_t)(len << 9 | sym);
+        }
+        return true;
+    }
+};
+
+// CRC-32 (gzip's, reflected 0xEDB88320) one byte at a time.
+static constexpr std::array<uint32_t, 256> CRC32_TABLE = [] {
+    std::array<uint32_t, 256> t{};
+    for (uint32_t i=0; i<256; ++i) {
+        uint32_t c = i;
+        for (int k=0; k<8; ++k) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        t[i] = c;
+    }
+    return t;
+}();
+
+// DEFLATE decoder for GD level data, behind a gzip or zlib header. The trailer's checksum
+// of the output (CRC-32 and size for gzip, Adler-32 for zlib) must match. Keeps its output
+// buffer between calls.
+class Inflater {
+public:
+    // next input chunk; returns its size, 0 at the end
+    using Source = std::function<size_t(const uint8_t*& data)>;
+    // decoded bytes, in order; returning false stops the inflate
+    using Sink = std::function<bool(const uint8_t* data, size_t n)>;
+
+    std::vector<uint8_t> out;
+
+    // whole buffer in, whole result in `out`
+    bool inflate(const uint8_t* data, size_t n) {
+        source = nullptr;
+        sink = nullptr;
+        in = data;
+        end = data + n;
+        size_t hint = n * 4;
+        if (!skipHeader(&hint)) return false;
+        out.resize(std::max<size_t>(hint, 64));
+        if (!run()) return false;
+        checksum(out.data(), pos);
+        out.resize(pos);
+        return trailerMatches();
+    }
+
+    // Streaming: input is pulled from `src` as needed and output is pushed to `snk` every
+    // INFLATE_CHUNK bytes, so memory stays bounded however large the data. The gzip or
+    // zlib header must lie in the first chunk.
+    bool inflate(Source src, Sink snk) {
+        source = std::move(src);
+        sink = std::move(snk);
+        const size_t n = source(in);
+        end = in + n;
+        if (!skipHeader(nullptr)) return false;
+        out.resize(INFLATE_CHUNK + INFLATE_WINDOW);
+        return run() && drain() && trailerMatches();
+    }
+
+private:
+    static constexpr size_t INFLATE_WINDOW = 32768;   // furthest a match reaches back
+    const uint8_t* in = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t bits = 0;
+    int nbits = 0;
+    bool overrun = false;
+    size_t pos = 0;
+    size_t drained = 0;   // out[0, drained) has gone to the sink
+    bool gzip = false;
+    uint32_t crc = 0, adlerA = 1, adlerB = 0, total = 0;   // of the output so far
+    Source source;
+    Sink sink;
+    HuffmanCode lit, dist, lens;
+
+    bool run() {
+        bits = 0;
+        nbits = 0;
+        overrun = false;
+        pos = 0;
+        drained = 0;
+        crc = 0;
+        adlerA = 1;
+        adlerB = 0;
+        total = 0;
+        for (;;) {
+            const uint32_t last = take(1), type = take(2);
+            bool ok = false;
+            if (type == 0) ok = stored();
+            else if (type == 1) ok = codes(fixedCodes().first, fixedCodes().second);
+            else if (type == 2) ok = dynamic();
+            if (!ok || overrun) return false;
+            if (last) return true;
+        }
+    }
+    void checksum(const uint8_t* p, size_t n) {
+        total += (uint32_t)n;
+        if (gzip) {
+            uint32_t c = ~crc;
+            for (size_t i=0; i<n; ++i) c = CRC32_TABLE[(c ^ p[i]) & 0xff] ^ (c >> 8);
+            crc = ~c;
+            return;
+        }
+        while (n > 0) {
+            const size_t run = std::min<size_t>(n, 5552);   // largest run whose sums fit 32 bits
+            for (size_t i=0; i<run; ++i) { adlerA += p[i]; adlerB += adlerA; }
+            adlerA %= 65521;
+            adlerB %= 65521;
+            p += run;
+            n -= run;
+        }
+    }
+    // the trailer after the last block, from the next byte boundary on
+    bool trailerMatches() {
+        bits >>= nbits & 7;
+        nbits -= nbits & 7;
+        auto word = [&](bool bigEndian) {
+            uint32_t v = 0;
+            for (int i=0; i<4; ++i) v |= take(8) << (bigEndian ? 24 - 8 * i : 8 * i);
+            return v;
+        };
+        if (gzip) {
+            const uint32_t c = word(false);
+            const uint32_t size = word(false);
+            return !overrun && c == crc && size == total;
+        }
+        const uint32_t a = word(true);
+        return !overrun && a == (adlerB << 16 | adlerA);
+    }
+    // hands the undrained output to the sink and keeps the last INFLATE_WINDOW bytes
+    bool drain() {
+        checksum(out.data() + drained, pos - drained);
+        if (pos > drained && !sink(out.data() + drained, pos - drained)) return false;
+        const size_t keep = std::min(pos, INFLATE_WINDOW);
+        std::memmove(out.data(), out.data() + pos - keep, keep);
+        pos = drained = keep;
+        return true;
+    }
+    // room for n more output bytes
+    bool reserve(size_t n) {
+        if (pos + n <= out.size()) return true;
+        if (sink) return drain();
+        out.resize(std::max(out.size() * 2, pos + n));
+        return true;
+    }
+    void refill() {
+        for (;;) {
+            while (nbits <= 56 && in < end) {
+                bits |= (uint64_t)*in++ << nbits;
+                nbits += 8;
+            }
+            if (nbits > 56 || !source) return;
+            const size_t n = source(in);
+            if (n == 0) { source = nullptr; return; }
+            end = in + n;
+        }
+    }
+    uint32_t take(int n) {
+        if (nbits < n) refill();
+        if (nbits < n) { overrun = true; return 0; }
+        const uint32_t v = (uint32_t)(bits & ((1ull << n) - 1));
+        bits >>= n;
+        nbits -= n;
+        return v;
+    }
+    int decode(const HuffmanCode& h) {
+        if (nbits < 15) refill();
+        const uint16_t e = h.fast[bits & ((1u << INFLATE_FAST_BITS) - 1)];
+        if (e && (e >> 9) <= nbits) {
+            bits >>= e >> 9;
+            nbits -= e >> 9;
+            return e & 0x1ff;
+        }
+        int code = 0, first = 0, index = 0;
+        for (int len=1; len<16; ++len) {
+            code |= (int)take(1);
+            const int c = h.count[len];
+            if (code - c < first) return h.symbol[index + (code - first)];
+            index += c;
+            first = (first + c) << 1;
+            code <<= 1;
+            if (overrun) break;
+        }
+        return -1;
+    }
+    // hint: gets the gzip size trailer as an estimate of the output size; null when streaming
+    bool skipHeader(size_t* hint) {
+        const size_t n = end - in;
+        if (n >= 18 && in[0] == 0x1f && in[1] == 0x8b && in[2] == 8) {
+            const uint8_t flags = in[3];
+            const uint8_t* p = in + 10;
+            if (flags & 4) { if (end - p < 2) return false; p += 2 + (p[0] | p[1] << 8); }
+            if (flags & 8) { while (p < end && *p) ++p; ++p; }
+            if (flags & 16) { while (p < end && *p) ++p; ++p; }
+            if (flags & 2) p += 2;
+            if (p > end) return false;
+            if (hint) {
+                if (p + 8 > end) return false;
+                const size_t size = (size_t)end[-4] | (size_t)end[-3] << 8 | (size_t)end[-2] << 16 | (size_t)end[-1] << 24;
+                *hint = std::min(size, n * 1032);   // DEFLATE expands at most 1032:1
+            }
+            in = p;
+            gzip = true;
+            return true;
+        }
+        if (n >= 6 && (in[0] & 0x0f) == 8 && ((in[0] << 8) | in[1]) % 31 == 0 && !(in[1] & 0x20)) {
+            in += 2;
+            gzip = false;
+            return true;
+        }
+        return false;
+    }
+    bool put(uint8_t b) {
+        if (!reserve(1)) return false;
+        out[pos++] = b;
+        return true;
+    }
+    bool stored() {
+        bits >>= nbits & 7;   // to a byte boundary
+        nbits -= nbits & 7;
+        const uint32_t len = take(16), nlen = take(16);
+        if (overrun || (len ^ 0xffff) != nlen) return false;
+        for (uint32_t i=0; i<len; ++i) {
+            const uint8_t b = (uint8_t)take(8);
+            if (overrun || !put(b)) return false;
+        }
+        return true;
+    }
+    bool dynamic() {
+        static constexpr uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        const int nlen = (int)take(5) + 257, ndist = (int)take(5) + 1, ncode = (int)take(4) + 4;
+        if (nlen > 286 || ndist > 30) return false;
+        uint8_t lengths[320] = {};
+        for (int i=0; i<ncode; ++i) lengths[ORDER[i]] = (uint8_t)take(3);
+        if (!lens.build(lengths, 19)) return false;
+        std::memset(lengths, 0, sizeof(lengths));
+        for (int i=0; i<nlen + ndist;) {
+            const int sym = decode(lens);
+            if (sym < 0) return false;
+            if (sym < 16) { lengths[i++] = (uint8_t)sym; continue; }
+            uint8_t v = 0;
+            int rep = 0;
+            if (sym == 16) { if (i == 0) return false; v = lengths[i-1]; rep = 3 + (int)take(2); }
+            else if (sym == 17) rep = 3 + (int)take(3);
+            else rep = 11 + (int)take(7);
+            if (i + rep > nlen + ndist) return false;
+            while (rep--) lengths[i++] = v;
+        }
+        if (lengths[256] == 0) return false;   // no end-of-block code
+        if (!lit.build(lengths, nlen) || !dist.build(lengths + nlen, ndist)) return false;
+        return codes(lit, dist);
+    }
+    bool codes(const HuffmanCode& l, const HuffmanCode& d) {
+        static constexpr uint16_t LBASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr uint8_t LEXT[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr uint16_t DBASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr uint8_t DEXT[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (;;) {
+            const int sym = decode(l);
+            if (sym < 0 || overrun) return false;
+            if (sym < 256) {
+                if (!put((uint8_t)sym)) return false;
+                continue;
+            }
+            if (sym == 256) return true;
+            if (sym > 285) return false;
+            const size_t len = LBASE[sym - 257] + take(LEXT[sym - 257]);
+            const int ds = decode(d);
+            if (ds < 0 || ds > 29) return false;
+            const size_t back = DBASE[ds] + take(DEXT[ds]);
+            if (back > pos || !reserve(len)) return false;
+            uint8_t* o = out.data() + pos;
+            for (size_t i=0; i<len; ++i) o[i] = o[i - back];   // may overlap itself
+            pos += len;
+        }
+    }
+    static const std::pair<HuffmanCode, HuffmanCode>& fixedCodes() {
+        static const std::pair<HuffmanCode, HuffmanCode> fixed = [] {
+            std::pair<HuffmanCode, HuffmanCode> f;
+            uint8_t lengths[288];
+            for (int i=0; i<288; ++i) lengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+            f.first.build(lengths, 288);
+            for (int i=0; i<30; ++i) lengths[i] = 5;
+            f.second.build(lengths, 30);
+            return f;
+        }();
+        return fixed;
+    }
+};
+
+// What an object ID is to the solver. Only solids, hazards and pads with a power are
+// simulated; every ID not in GD_OBJECTS is decoration.
+enum class GDCategory : uint8_t { DECORATION, SOLID, HAZARD, PAD, ORB, PORTAL };
+// Where the default hitbox sits in the object's grid cell: on its bottom, or centred on the
+// object like saws, orbs and portals.
+enum class GDAnchor : uint8_t { CELL_BOTTOM, CENTRE };
+
+struct GDObjectKind {
+    int id;
+    GDCategory category;
+    float w, h;         // default hitbox, unscaled
+    float power;
+    GDAnchor anchor = GDAnchor::CELL_BOTTOM;
+};
+// Every GD object ID that is not decoration, grouped by category, with the hitbox it gets
+// when GD gives none. The simulator's player is a point, so blocks and spikes fill their
+// whole cell. Order does not matter; lookups go through GD_OBJECT_TABLE.
+static constexpr GDObjectKind GD_OBJECTS[] = {
+    {1, GDCategory::SOLID, 30, 30, 0},                       // default block
+    {2, GDCategory::SOLID, 30, 30, 0},                       // grid blocks
+    {3, GDCategory::SOLID, 30, 30, 0},
+    {4, GDCategory::SOLID, 30, 30, 0},
+    {5, GDCategory::SOLID, 30, 30, 0},
+    {6, GDCategory::SOLID, 30, 30, 0},
+    {7, GDCategory::SOLID, 30, 30, 0},
+    {40, GDCategory::SOLID, 30, 15, 0},                      // slab
+    {83, GDCategory::SOLID, 30, 30, 0},                      // brick block
+    {8, GDCategory::HAZARD, 30, 30, 0},                      // spike
+    {39, GDCategory::HAZARD, 30, 15, 0},                     // half spike
+    {103, GDCategory::HAZARD, 30, 20, 0},                    // medium spike
+    {9, GDCategory::HAZARD, 30, 14, 0},                      // ground spikes
+    {61, GDCategory::HAZARD, 30, 14, 0},
+    {88, GDCategory::HAZARD, 64, 64, 0, GDAnchor::CENTRE},   // saw blades, large to small
+    {89, GDCategory::HAZARD, 44, 44, 0, GDAnchor::CENTRE},
+    {98, GDCategory::HAZARD, 24, 24, 0, GDAnchor::CENTRE},
+    {35, GDCategory::PAD, 30, 16, 900},                      // yellow pad
+    {140, GDCategory::PAD, 30, 16, 580},                     // pink pad
+    {1332, GDCategory::PAD, 30, 16, 1100},                   // red pad
+    {67, GDCategory::PAD, 30, 16, 0},                        // blue (gravity) pad
+    {3005, GDCategory::PAD, 30, 16, 0},                      // spider pad
+    {36, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},      // yellow, blue, pink, green, black, red orbs
+    {84, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {141, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {1022, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {1330, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {1333, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {1594, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},    // toggle orb
+    {1704, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},    // dash orbs
+    {1751, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},
+    {3004, GDCategory::ORB, 36, 36, 0, GDAnchor::CENTRE},    // spider orb
+    {10, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},   // gravity portals
+    {11, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {2902, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {12, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},   // cube, ship, ball, UFO, wave, robot, spider, swing
+    {13, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {47, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {111, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {660, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {745, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {1331, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {1933, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {45, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},   // mirror on, off
+    {46, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {99, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},   // mini, normal size
+    {101, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {286, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},  // dual on, off
+    {287, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},
+    {747, GDCategory::PORTAL, 34, 86, 0, GDAnchor::CENTRE},  // teleport
+    {200, GDCategory::PORTAL, 34, 44, 0, GDAnchor::CENTRE},  // speed changes
+    {201, GDCategory::PORTAL, 34, 44, 0, GDAnchor::CENTRE},
+    {202, GDCategory::PORTAL, 34, 44, 0, GDAnchor::CENTRE},
+    {203, GDCategory::PORTAL, 34, 44, 0, GDAnchor::CENTRE},
+    {1334, GDCategory::PORTAL, 34, 44, 0, GDAnchor::CENTRE},
+};
+static constexpr float GD_FLOOR_MARGIN = 90.0f;   // px of GD's implicit floor past the last object
+
+// GD_OBJECTS as a perfect hash: the top GD_HASH_BITS bits of id * multiplier pick a slot
+// no other listed ID shares, so a lookup is one multiply-shift and one compare. The
+// multiplier is found at compile time; empty slots hold decoration.
+static constexpr unsigned GD_HASH_BITS = 8;
+struct GDObjectTable {
+    uint32_t multiplier;
+    std::array<GDObjectKind, 1u << GD_HASH_BITS> slots;
+};
+static constexpr uint32_t gdHashSlot(uint32_t multiplier, int id) {
+    return (uint32_t)id * multiplier >> (32 - GD_HASH_BITS);
+}
+static constexpr GDObjectTable GD_OBJECT_TABLE = [] {
+    GDObjectTable table{};
+    // odd multipliers from an LCG seeded with the golden ratio's (neighbouring multipliers
+    // collide alike on small IDs); running out of tries fails the build
+    for (uint32_t multiplier = 0x9E3779B1u;; multiplier = (multiplier * 1664525u + 1013904223u) | 1u) {
+        std::array<bool, 1u << GD_HASH_BITS> used{};
+        bool perfect = true;
+        for (const GDObjectKind& k : GD_OBJECTS) {
+            const uint32_t slot = gdHashSlot(multiplier, k.id);
+            if (used[slot]) { perfect = false; break; }
+            used[slot] = true;
+        }
+        if (!perfect) continue;
+        table.multiplier = multiplier;
+        for (const GDObjectKind& k : GD_OBJECTS) table.slots[gdHashSlot(multiplier, k.id)] = k;
+        return table;
+    }
+}();
+static constexpr GDObjectKind GD_DECORATION{0, GDCategory::DECORATION, 0, 0, 0};
+
+static constexpr const GDObjectKind& classifyGDObject(int id) {
+    const GDObjectKind& k = GD_OBJECT_TABLE.slots[gdHashSlot(GD_OBJECT_TABLE.multiplier, id)];
+    return k.id == id ? k : GD_DECORATION;
+}
+static_assert(classifyGDObject(8).category == GDCategory::HAZARD && classifyGDObject(1334).category == GDCategory::PORTAL, "GD object table");
+static_assert(classifyGDObject(0).category == GDCategory::DECORATION && classifyGDObject(1000000).category == GDCategory::DECORATION, "GD object table");
+
+// The simulator's type for a kind, or false for kinds it does not simulate.
+static bool gdSolverType(const GDObjectKind& kind, ObjType& type) {
+    switch (kind.category) {
+    case GDCategory::SOLID: type = ObjType::PLATFORM; return true;
+    case GDCategory::HAZARD: type = ObjType::SPIKE; return true;
+    case GDCategory::PAD: type = ObjType::JUMP_PAD; return kind.power > 0.0f;
+    default: return false;
+    }
+}
+
+// Where an object of the given kind sits when GD places its centre at (x, y): the kind's
+// size, scaled, centred or resting on the bottom of its grid cell - the top when flipped
+// vertically - and then turned clockwise about the centre, as GD turns it.
+static Rect gdObjectRect(const GDObjectKind& kind, float x, float y, float rotation, float scaleX, float scaleY, bool flipY) {
+    const int turn = ((int)std::lround(rotation / 90.0f) % 4 + 4) % 4;   // quarter turns
+    float w = kind.w * scaleX, h = kind.h * scaleY;
+    // offset of the rect's centre from the object's, before turning
+    float dx = 0.0f, dy = kind.anchor == GDAnchor::CENTRE ? 0.0f : h * 0.5f - 15.0f * scaleY;
+    if (flipY) dy = -dy;
+    for (int i=0; i<turn; ++i) {
+        const float t = dx;
+        dx = dy;
+        dy = -t;
+        std::swap(w, h);
+    }
+    return {x + dx - w * 0.5f, y + dy - h * 0.5f, w, h};
+}
+
+// Scratch buffers for decoding GD level strings; reusing one decoder keeps the decode
+// free of allocations once the buffers have grown.
+class LevelDecoder {
+public:
+    static bool looksEncoded(std::string_view bytes) {
+        bytes = trimView(bytes);
+        if (bytes.size() < 4) return false;
+        const uint32_t a = BASE64_VALUES[(uint8_t)bytes[0]], b = BASE64_VALUES[(uint8_t)bytes[1]], c = BASE64_VALUES[(uint8_t)bytes[2]];
+        if ((a | b | c) & 0x80) return false;
+        const uint32_t b0 = a << 2 | b >> 4, b1 = (b & 15) << 4 | c >> 2;
+        return (b0 == 0x1f && b1 == 0x8b) || ((b0 & 0x0f) == 8 && ((b0 << 8) | b1) % 31 == 0);
+    }
+
+    // Objects the simulator does not know are counted in `ignored`; `line` of an error is the
+    // object's index in the string.
+    ParseResult decode(std::string_view encoded, std::vector<Obj>& out) {
+        out.clear();
+        ParseResult res;
+        if (!decodeBase64(trimView(encoded), raw)) { res.error = ParseError::BAD_BASE64; return res; }
+        if (!inflater.inflate(raw.data(), raw.size())) { res.error = ParseError::BAD_DEFLATE; return res; }
+        std::string_view text((const char*)inflater.out.data(), inflater.out.size());
+        size_t pos = text.find(';');   // level settings
+        if (pos == std::string_view::npos) return res;
+        ++pos;
+        float x0 = INFINITY, x1 = -INFINITY;
+        for (int index=1; pos < text.size(); ++index) {
+            size_t semi = text.find(';', pos);
+            if (semi == std::string_view::npos) semi = text.size();
+            const std::string_view obj = text.substr(pos, semi - pos);
+            pos = semi + 1;
+            if (obj.empty()) continue;
+            float fields[6] = {0, 0, 0, 0, 1, 0};   // ID, x, y, rotation, scale, flip Y
+            bool haveId = false;
+            size_t at = 0;
+            while (at < obj.size()) {
+                size_t comma = obj.find(',', at);
+                if (comma == std::string_view::npos) break;
+                int key = 0;
+                auto [kp, kec] = std::from_chars(obj.data() + at, obj.data() + comma, key);
+                size_t next = obj.find(',', comma + 1);
+                if (next == std::string_view::npos) next = obj.size();
+                const std::string_view value = obj.substr(comma + 1, next - comma - 1);
+                at = next + 1;
+                if (kec != std::errc() || kp != obj.data() + comma) continue;   // keys like kA on settings
+                const int slot = key == 1 ? 0 : key == 2 ? 1 : key == 3 ? 2 : key == 6 ? 3 : key == 32 ? 4 : key == 5 ? 5 : -1;
+                if (slot < 0) continue;
+                if (!parseFloat(value, fields[slot])) { res.error = ParseError::BAD_NUMBER; res.line = index; return res; }
+                haveId |= slot == 0;
+            }
+            if (!haveId) continue;
+            const GDObjectKind& kind = classifyGDObject((int)fields[0]);
+            Obj o;
+            if (!gdSolverType(kind, o.type)) { ++res.ignored; continue; }
+            const float scale = fields[4] > 0.0f ? fields[4] : 1.0f;
+            o.power = kind.power;
+            o.r = gdObjectRect(kind, fields[1], fields[2], fields[3], scale, scale, fields[5] != 0.0f);
+            out.push_back(o);
+            x0 = std::min(x0, o.r.x);
+            x1 = std::max(x1, o.r.x + o.r.w);
+        }
+        if (x0 <= x1) {
+            // GD's floor, top at y = 0
+            Obj floor;
+            floor.type = ObjType::PLATFORM;
+            floor.r = {std::min(x0, 0.0f), -30.0f, x1 - std::min(x0, 0.0f) + GD_FLOOR_MARGIN, 30.0f};
+            out.push_back(floor);
+        }
+        return res;
+    }
+
+private:
+    std::vector<uint8_t> raw;
+    Inflater inflater;
+};
+
+// Live level snapshot (.pfs): the GD objects exactly as extractLive read them, before they
+// are turned into solver objects, so an in-game failure replays offline. A SnapshotHeader,
+// then one array per field, count entries each: id, the float columns x, y, rotation,
+// scaleX, scaleY, hitX, hitY, hitW, hitH (floatFields' order), group, then flags (version
+// 2 on; version 1 files load with no flags set).
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+};
+static constexpr char SNAPSHOT_MAGIC[4] = {'P', 'F', 'S', 'N'};
+static constexpr uint32_t SNAPSHOT_VERSION = 2;
+static constexpr uint8_t SNAPSHOT_FLIP_Y = 1;
+
+struct LevelSnapshot {
+    std::vector<int32_t> id;
+    std::vector<float> x, y;              // object centre
+    std::vector<float> rotation;          // degrees
+    std::vector<float> scaleX, scaleY;
+    std::vector<int32_t> group;           // first group ID, 0 for none
+    std::vector<float> hitX, hitY, hitW, hitH;   // GD's hitbox; zero size when it has none
+    std::vector<uint8_t> flags;           // SNAPSHOT_FLIP_Y
+
+    static bool isSnapshot(std::string_view bytes) {
+        return bytes.size() >= sizeof(SNAPSHOT_MAGIC) && std::memcmp(bytes.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+    }
+    size_t size() const { return id.size(); }
+    void resize(size_t n) {
+        id.resize(n);
+        group.resize(n);
+        flags.resize(n);
+        for (std::vector<float>* f : floatFields()) f->resize(n);
+    }
+
+    bool save(const std::filesystem::path& p, std::string& err) const {
+        SnapshotHeader hdr;
+        std::memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+        hdr.version = SNAPSHOT_VERSION;
+        hdr.count = (uint32_t)size();
+        std::ofstream f(p, std::ios::binary | std::ios::trunc);
+        f.write((const char*)&hdr, sizeof(hdr));
+        f.write((const char*)id.data(), (std::streamsize)(size() * sizeof(int32_t)));
+        for (const std::vector<float>* v : floatFields()) f.write((const char*)v->data(), (std::streamsize)(size() * sizeof(float)));
+        f.write((const char*)group.data(), (std::streamsize)(size() * sizeof(int32_t)));
+        f.write((const char*)flags.data(), (std::streamsize)size());
+        if (!f) { err = "cannot write " + p.string(); return false; }
+        return true;
+    }
+    bool load(std::string_view bytes) {
+        SnapshotHeader hdr;
+        if (!isSnapshot(bytes) || bytes.size() < sizeof(hdr)) return false;
+        std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+        const size_t n = hdr.count;
+        const size_t entry = hdr.version == 1 ? ENTRY_BYTES - 1 : ENTRY_BYTES;
+        if ((hdr.version != 1 && hdr.version != SNAPSHOT_VERSION) || bytes.size() != sizeof(hdr) + n * entry) return false;
+        resize(n);
+        const char* at = bytes.data() + sizeof(hdr);
+        std::memcpy(id.data(), at, n * sizeof(int32_t));
+        at += n * sizeof(int32_t);
+        for (std::vector<float>* v : floatFields()) {
+            std::memcpy(v->data(), at, n * sizeof(float));
+            at += n * sizeof(float);
+        }
+        std::memcpy(group.data(), at, n * sizeof(int32_t));
+        at += n * sizeof(int32_t);
+        if (hdr.version == 1) std::fill(flags.begin(), flags.end(), 0);
+        else std::memcpy(flags.data(), at, n);
+        return true;
+    }
+
+    // Solver objects: the kinds the simulator knows, with GD's hitbox, or the table's
+    // default when there is none. Orbs, portals and decoration are counted in `ignored`.
+    ParseResult toObjects(std::vector<Obj>& out) const {
+        out.clear();
+        out.reserve(size());
+        ParseResult res;
+        for (size_t i=0; i<size(); ++i) {
+            const GDObjectKind& kind = classifyGDObject(id[i]);
+            Obj o;
+            if (!gdSolverType(kind, o.type)) { ++res.ignored; continue; }
+            o.power = kind.power;
+            if (hitW[i] > 0.0f && hitH[i] > 0.0f) o.r = {hitX[i], hitY[i], hitW[i], hitH[i]};
+            else o.r = gdObjectRect(kind, x[i], y[i], rotation[i], scaleX[i], scaleY[i], (flags[i] & SNAPSHOT_FLIP_Y) != 0);
+            out.push_back(o);
+        }
+        return res;
+    }
+
+private:
+    static constexpr size_t ENTRY_BYTES = 2 * sizeof(int32_t) + 9 * sizeof(float) + sizeof(uint8_t);
+    std::array<std::vector<float>*, 9> floatFields() { return {&x, &y, &rotation, &scaleX, &scaleY, &hitX, &hitY, &hitW, &hitH}; }
+    std::array<const std::vector<float>*, 9> floatFields() const { return {&x, &y, &rotation, &scaleX, &scaleY, &hitX, &hitY, &hitW, &hitH}; }
+};
+
+// Streaming reader for GD's save plist (CCLocalLevels.dat once decoded). Text is fed in
+// arbitrary pieces; every level dict - the dicts three deep, under LLM_01 - that holds a
+// level string (k4) is handed on with its name (k2). Only the unfinished tail of the text
+// is kept between pieces.
+class PlistLevelScanner {
+public:
+    using LevelCallback = std::function<void(std::string name, std::string data)>;
+
+    explicit PlistLevelScanner(LevelCallback onLevel) : onLevel(std::move(onLevel)) {}
+
+    void feed(const char* text, size_t n) {
+        buf.append(text, n);
+        for (;;) {
+            const size_t lt = buf.find('<', scan);
+            if (lt == std::string::npos) { scan = buf.size(); break; }
+            const size_t gt = buf.find('>', lt);
+            if (gt == std::string::npos) { scan = lt; break; }
+            tag(std::string_view(buf).substr(lt + 1, gt - lt - 1), std::string_view(buf).substr(textStart, lt - textStart));
+            textStart = scan = gt + 1;
+        }
+        buf.erase(0, textStart);
+        scan -= textStart;
+        textStart = 0;
+    }
+
+private:
+    LevelCallback onLevel;
+    std::string buf;
+    size_t scan = 0, textStart = 0;   // where to look for the next tag; where the current text began
+    int depth = 0;
+    std::string key, name, data;
+
+    // text is everything between the previous tag and this one
+    void tag(std::string_view t, std::string_view text) {
+        if (t == "d" || t == "dict") {
+            if (++depth == 3) { name.clear(); data.clear(); }
+        } else if (t == "/d" || t == "/dict") {
+            if (depth == 3 && !data.empty()) onLevel(std::move(name), std::move(data));
+            --depth;
+        } else if (t == "/k") {
+            key.assign(text);
+        } else if (t == "/s" && depth == 3) {
+            if (key == "k2") name = unescapeXml(text);
+            else if (key == "k4") data.assign(text);
+        }
+    }
+    static std::string unescapeXml(std::string_view s) {
+        static constexpr std::pair<std::string_view, char> ENTITIES[] = {{"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+        std::string r;
+        for (size_t i=0; i<s.size(); ++i) {
+            bool hit = false;
+            if (s[i] == '&')
+                for (auto const& e : ENTITIES)
+                    if (s.substr(i, e.first.size()) == e.first) { r += e.second; i += e.first.size() - 1; hit = true; break; }
+            if (!hit) r += s[i];
+        }
+        return r;
+    }
+};
+
+// Streams the levels out of a GD save file: XOR 11, base64, gzip, plist - or any of those
+// layers already removed. Memory stays at a couple of chunks plus the level being read.
+static bool readSaveLevels(const std::filesystem::path& p, const PlistLevelScanner::LevelCallback& onLevel, std::string& err) {
+    MappedFile f;
+    if (!f.open(p, err)) return false;
+    std::string_view file(f.data(), f.size());
+    PlistLevelScanner scanner(onLevel);
+    if (trimView(file).substr(0, 1) == "<") {   // plain plist
+        scanner.feed(file.data(), file.size());
+        return true;
+    }
+    uint8_t key = 11;
+    if (file.size() >= 4 && file.substr(0, 4) == "H4sI") key = 0;
+    else if (file.size() < 4 || (char)(file[0] ^ key) != 'H' || (char)(file[1] ^ key) != '4') { err = "not a GD save file"; return false; }
+    // un-XOR and base64-decode one chunk at a time, carrying partial base64 groups over
+    size_t at = 0;
+    std::string chars;
+    std::vector<uint8_t> bytes;
+    auto source = [&](const uint8_t*& data) -> size_t {
+        while (at < file.size()) {
+            const size_t stop = std::min(file.size(), at + SAVE_CHUNK);
+            for (; at < stop; ++at) {
+                const char c = (char)(file[at] ^ key);
+                if (!(BASE64_VALUES[(uint8_t)c] & 0x80)) chars += c;   // drops padding and stray bytes
+            }
+            const size_t whole = at < file.size() ? chars.size() / 4 * 4 : chars.size();
+            if (!decodeBase64(std::string_view(chars).substr(0, whole), bytes)) return 0;
+            chars.erase(0, whole);
+            if (!bytes.empty()) {
+                data = bytes.data();
+                return bytes.size();
+            }
+        }
+        return 0;
+    };
+    Inflater inflater;
+    if (!inflater.inflate(source, [&](const uint8_t* d, size_t n) { scanner.feed((const char*)d, n); return true; })) {
+        err = "corrupt save data";
+        return false;
+    }
+    return true;
+}
+
+// Reads a text, binary or GD-encoded level or a live snapshot, whichever the bytes hold.
+// Pattern libraries and level packs are refused with their own errors.
+static ParseResult parseLevelBytes(std::string_view bytes, std::vector<Obj>& out) {
+    if (isBinaryLevel(bytes)) return loadBinaryLevel(bytes, out);
+    const ParseError notLevel = notALevel(bytes);
+    if (notLevel != ParseError::NONE) {
+        out.clear();
+        ParseResult res;
+        res.error = notLevel;
+        return res;
+    }
+    if (LevelSnapshot::isSnapshot(bytes)) {
+        LevelSnapshot snap;
+        if (snap.load(bytes)) return snap.toObjects(out);
+        out.clear();
+        ParseResult res;
+        res.error = ParseError::BAD_BINARY;
+        return res;
+    }
+    if (LevelDecoder::looksEncoded(bytes)) {
+        thread_local LevelDecoder decoder;
+        return decoder.decode(bytes, out);
+    }
+    return parseLevelTextParallel(bytes, out);
+}
+
+static ParseResult parseLevelFile(const std::filesystem::path& p, std::vector<Obj>& out) {
+    MappedFile f;
+    std::string err;
+    if (!f.open(p, err)) {
+        out.clear();
+        ParseResult res;
+        res.error = ParseError::OPEN_FAILED;
+        return res;
+    }
+    return parseLevelBytes(std::string_view(f.data(), f.size()), out);
+}
+
+static std::string parseDebug(const ParseResult& res) {
+    std::ostringstream dbgoss;
+    if (res.error != ParseError::NONE) {
+        dbgoss << parseErrorName(res.error);
+        if (res.line > 0) dbgoss << " at line " << res.line;
+    } else if (res.ignored > 0) {
+        dbgoss << "ignored " << res.ignored << " lines\n";
+    }
+    return dbgoss.str();
+}
+
+// parse level.txt fallback
+static bool parseLevelFile(const std::filesystem::path& p, std::vector<Obj>& out, std::string& dbg) {
+    const ParseResult res = parseLevelFile(p, out);
+    dbg = parseDebug(res);
+    return res.error == ParseError::NONE;
+}
+
+// Level pack (.pfk): many levels in one file, read in place from the mapping.
+//   PackHeader, then the shape table (PackHeader::shapes pairs of float w, h), then one
+//   block per level, then the index (PackEntry, sorted by name hash), then the names,
+//   each NUL-terminated.
+// A block holds the platform, spike and pad counts as varints, then each type's objects
+// in x order. Every coordinate is a varint: twice its difference from the previous value
+// of that field, on the half-pixel grid, or 1 followed by the raw float bits off the grid.
+// Sizes that occur often across the pack are taken from the shape table - trained when
+// the pack is written - as a one-byte index; others are spelled out after a 0.
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t shapes;
+    uint64_t indexOffset;
+    uint64_t namesOffset;
+};
+struct PackEntry {
+    uint64_t hash;      // of the name
+    uint64_t offset;    // of the block
+    uint32_t size;
+    uint32_t name;      // offset into the names
+};
+static constexpr uint32_t PACK_VERSION = 1;
+
+static uint64_t packNameHash(std::string_view name) {
+    uint64_t h = 1469598103934665603ull;
+    for (char c : name) h = (h ^ (uint8_t)c) * 1099511628211ull;
+    return h;
+}
+
+static void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) { out += (char)(v | 0x80); v >>= 7; }
+    out += (char)v;
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift=0; p < end && shift < 64; shift += 7) {
+        const uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static void putCoord(std::string& out, float v, float base) {
+    const double q = (double)v * 2.0, qb = (double)base * 2.0;
+    if (q == std::floor(q) && qb == std::floor(qb) && std::fabs(q) < 1e15 && std::fabs(qb) < 1e15 && !(v == 0.0f && std::signbit(v))) {
+        const int64_t d = (int64_t)q - (int64_t)qb;
+        putVarint(out, ((uint64_t)d << 1 ^ (uint64_t)(d >> 63)) << 1);   // zigzag, tag bit 0
+        return;
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    putVarint(out, 1);
+    out.append((const char*)&bits, sizeof(bits));
+}
+
+static bool getCoord(const uint8_t*& p, const uint8_t* end, float base, float& v) {
+    uint64_t t;
+    if (!getVarint(p, end, t)) return false;
+    if (t & 1) {
+        if (end - p < 4) return false;
+        std::memcpy(&v, p, sizeof(v));
+        p += 4;
+        return true;
+    }
+    const uint64_t z = t >> 1;
+    const int64_t d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+    v = (float)(((double)base * 2.0 + (double)d) / 2.0);
+    return true;
+}
+
+class LevelPack {
+public:
+    bool open(const std::filesystem::path& p, std::string& err) {
+        if (!file.open(p, err)) return false;
+        if (file.size() < sizeof(hdr)) { err = "not a level pack"; return false; }
+        std::memcpy(&hdr, file.data(), sizeof(hdr));
+        if (std::memcmp(hdr.magic, PACK_MAGIC, 4) != 0) { err = "not a level pack"; return false; }
+        if (hdr.version != PACK_VERSION || hdr.indexOffset + (uint64_t)hdr.count * sizeof(PackEntry) > hdr.namesOffset || hdr.namesOffset > file.size()
+            || sizeof(hdr) + (uint64_t)hdr.shapes * 2 * sizeof(float) > file.size()) {
+            err = "unsupported or truncated level pack";
+            return false;
+        }
+        return true;
+    }
+    static bool isPack(const std::filesystem::path& p) {
+        char magic[4] = {};
+        std::ifstream f(p, std::ios::binary);
+        return f.read(magic, 4) && std::memcmp(magic, PACK_MAGIC, 4) == 0;
+    }
+    int size() const { return (int)hdr.count; }
+    std::string_view name(int i) const {
+        const char* names = file.data() + hdr.namesOffset;
+        const size_t at = entry(i).name, n = file.size() - hdr.namesOffset;
+        return at < n ? std::string_view(names + at, strnlen(names + at, n - at)) : std::string_view();
+    }
+    // index of the level with this name, or -1
+    int find(std::string_view levelName) const {
+        const uint64_t h = packNameHash(levelName);
+        int lo = 0, hi = size();
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (entry(mid).hash < h) lo = mid + 1; else hi = mid;
+        }
+        for (; lo < size() && entry(lo).hash == h; ++lo)
+            if (name(lo) == levelName) return lo;
+        return -1;
+    }
+    ParseResult load(int i, std::vector<Obj>& out) const {
+        out.clear();
+        ParseResult res;
+        const PackEntry e = entry(i);
+        if (e.offset + e.size > hdr.indexOffset) { res.error = ParseError::BAD_BINARY; return res; }
+        const uint8_t* p = (const uint8_t*)file.data() + e.offset;
+        const uint8_t* end = p + e.size;
+        const float* shapes = (const float*)(file.data() + sizeof(hdr));
+        uint64_t counts[3];
+        for (uint64_t& c : counts)
+            if (!getVarint(p, end, c) || c > e.size) { res.error = ParseError::BAD_BINARY; return res; }
+        static constexpr ObjType TYPES[3] = {ObjType::PLATFORM, ObjType::SPIKE, ObjType::JUMP_PAD};
+        out.reserve(counts[0] + counts[1] + counts[2]);
+        for (int t=0; t<3; ++t) {
+            float x = 0.0f, y = 0.0f;
+            for (uint64_t k=0; k<counts[t]; ++k) {
+                Obj o;
+                o.type = TYPES[t];
+                uint64_t shape;
+                bool ok = getCoord(p, end, x, o.r.x) && getCoord(p, end, y, o.r.y) && getVarint(p, end, shape);
+                if (ok && shape > 0 && shape <= hdr.shapes) { o.r.w = shapes[2 * shape - 2]; o.r.h = shapes[2 * shape - 1]; }
+                else if (ok && shape == 0) ok = getCoord(p, end, 0.0f, o.r.w) && getCoord(p, end, 0.0f, o.r.h);
+                else ok = false;
+                if (ok && o.type == ObjType::JUMP_PAD) ok = getCoord(p, end, 0.0f, o.power);
+                if (!ok) { res.error = ParseError::BAD_BINARY; out.clear(); return res; }
+                x = o.r.x;
+                y = o.r.y;
+                out.push_back(o);
+            }
+        }
+        return res;
+    }
+
+    // Writes a pack of the given levels; each level is read twice, once to train the
+    // shape table and once to encode it, so only one is in memory at a time.
+    static bool write(const std::filesystem::path& p, const std::vector<std::string>& paths, std::string& err) {
+        std::map<std::pair<uint32_t, uint32_t>, size_t> seen;
+        std::set<std::string> levelNames;
+        std::vector<Obj> objs;
+        std::string dbg;
+        for (const std::string& path : paths) {
+            if (!levelNames.insert(std::filesystem::path(path).stem().string()).second) { err = "two levels named " + std::filesystem::path(path).stem().string(); return false; }
+            if (!parseLevelFile(path, objs, dbg)) { err = path + ": " + dbg; return false; }
+            for (const Obj& o : objs) ++seen[{floatBits(o.r.w), floatBits(o.r.h)}];
+        }
+        std::vector<std::pair<size_t, std::pair<uint32_t, uint32_t>>> byUse;
+        for (auto const& s : seen) byUse.push_back({s.second, s.first});
+        std::sort(byUse.begin(), byUse.end(), [](auto const& a, auto const& b) { return a.first > b.first; });
+        byUse.resize(std::min(byUse.size(), PACK_SHAPES));
+        std::map<std::pair<uint32_t, uint32_t>, uint64_t> shapeIndex;
+        std::vector<float> shapes;
+        for (auto const& s : byUse) {
+            shapeIndex[s.second] = shapes.size() / 2 + 1;
+            float w, h;
+            std::memcpy(&w, &s.second.first, 4);
+            std::memcpy(&h, &s.second.second, 4);
+            shapes.push_back(w);
+            shapes.push_back(h);
+        }
+        std::ofstream f(p, std::ios::binary | std::ios::trunc);
+        PackHeader hdr{};
+        std::memcpy(hdr.magic, PACK_MAGIC, 4);
+        hdr.version = PACK_VERSION;
+        hdr.count = (uint32_t)paths.size();
+        hdr.shapes = (uint32_t)(shapes.size() / 2);
+        f.write((const char*)&hdr, sizeof(hdr));
+        f.write((const char*)shapes.data(), (std::streamsize)(shapes.size() * sizeof(float)));
+        uint64_t at = sizeof(hdr) + shapes.size() * sizeof(float);
+        std::vector<PackEntry> index;
+        std::string names, block;
+        for (const std::string& path : paths) {
+            if (!parseLevelFile(path, objs, dbg)) { err = path + ": " + dbg; return false; }
+            block.clear();
+            static constexpr ObjType TYPES[3] = {ObjType::PLATFORM, ObjType::SPIKE, ObjType::JUMP_PAD};
+            std::vector<Obj> groups[3];
+            for (const Obj& o : objs)
+                for (int t=0; t<3; ++t) if (o.type == TYPES[t]) groups[t].push_back(o);
+            for (auto& g : groups) {
+                std::stable_sort(g.begin(), g.end(), [](const Obj& a, const Obj& b) { return a.r.x < b.r.x; });
+                putVarint(block, g.size());
+            }
+            for (const auto& g : groups) {
+                float x = 0.0f, y = 0.0f;
+                for (const Obj& o : g) {
+                    putCoord(block, o.r.x, x);
+                    putCoord(block, o.r.y, y);
+                    auto s = shapeIndex.find({floatBits(o.r.w), floatBits(o.r.h)});
+                    if (s != shapeIndex.end()) {
+                        putVarint(block, s->second);
+                    } else {
+                        putVarint(block, 0);
+                        putCoord(block, o.r.w, 0.0f);
+                        putCoord(block, o.r.h, 0.0f);
+                    }
+                    if (o.type == ObjType::JUMP_PAD) putCoord(block, o.power, 0.0f);
+                    x = o.r.x;
+                    y = o.r.y;
+                }
+            }
+            const std::string levelName = std::filesystem::path(path).stem().string();
+            index.push_back({packNameHash(levelName), at, (uint32_t)block.size(), (uint32_t)names.size()});
+            names.append(levelName).push_back('\0');
+            f.write(block.data(), (std::streamsize)block.size());
+            at += block.size();
+        }
+        std::stable_sort(index.begin(), index.end(), [](const PackEntry& a, const PackEntry& b) { return a.hash < b.hash; });
+
+        hdr.indexOffset = at;
+        hdr.namesOffset = at + index.size() * sizeof(PackEntry);
+        f.write((const char*)index.data(), (std::streamsize)(index.size() * sizeof(PackEntry)));
+        f.write(names.data(), (std::streamsize)names.size());
+        f.seekp(0);
+        f.write((const char*)&hdr, sizeof(hdr));
+        if (!f) { err = "cannot write " + p.string(); return false; }
+        return true;
+    }
+
+private:
+    MappedFile file;
+    PackHeader hdr{};
+
+    PackEntry entry(int i) const {
+        PackEntry e;
+        std::memcpy(&e, file.data() + hdr.indexOffset + (size_t)i * sizeof(PackEntry), sizeof(e));
+        return e;
+    }
+    static uint32_t floatBits(float v) {
+        uint32_t b;
+        std::memcpy(&b, &v, sizeof(b));
+        return b;
+    }
+};
+
+// A level read in increasing x a piece at a time, from a binary level (convert writes its
+// arrays sorted by x) or from a level.txt already sorted by x. Pages that have been read
+// are dropped from memory again.
+class LevelStream {
+public:
+    bool open(const std::filesystem::path& p, std::string& err) {
+        if (!file.open(p, err)) return false;
+        const std::string_view bytes(file.data(), file.size());
+        const ParseError notLevel = notALevel(bytes);
+        if (notLevel != ParseError::NONE) {
+            err = parseErrorName(notLevel);
+            return false;
+        }
+        if (isBinaryLevel(bytes)) {
+            LevelFileHeader hdr;
+            if (bytes.size() < sizeof(hdr)) { err = parseErrorName(ParseError::BAD_BINARY); return false; }
+            std::memcpy(&hdr, bytes.data(), sizeof(hdr));
+            size_t offset = sizeof(hdr);
+            auto place = [&offset](Array& a, uint32_t count, size_t stride, ObjType type) {
+                a.offset = offset;
+                a.count = count;
+                a.stride = stride;
+                a.type = type;
+                offset += count * stride;
+            };
+            place(arrays[0], hdr.platforms, sizeof(Rect), ObjType::PLATFORM);
+            place(arrays[1], hdr.spikes, sizeof(Rect), ObjType::SPIKE);
+            place(arrays[2], hdr.pads, sizeof(LevelPad), ObjType::JUMP_PAD);
+            if (hdr.version != LEVEL_VERSION || bytes.size() < offset) {
+                err = parseErrorName(ParseError::BAD_BINARY);
+                return false;
+            }
+            binary = true;
+            for (Array& a : arrays) if (!fetch(a, err)) return false;
+        }
+        return advance(err);
+    }
+    bool done() const { return !hasHead; }
+    float nextX() const { return head.r.x; }
+
+    // Appends every object whose left edge lies below x. False on a read error.
+    bool readUntil(float x, std::vector<Obj>& out, std::string& err) {
+        while (hasHead && head.r.x < x) {
+            out.push_back(head);
+            if (!advance(err)) return false;
+        }
+        if (binary) {
+            for (const Array& a : arrays) file.release(a.offset, a.offset + a.next * a.stride);
+        } else {
+            file.release(0, textPos);
+        }
+        return true;
+    }
+
+private:
+    struct Array {
+        size_t offset = 0;
+        uint32_t count = 0;
+        size_t stride = 0;
+        ObjType type = ObjType::UNKNOWN;
+        uint32_t next = 0;   // elements read
+        bool has = false;
+        Obj obj;             // element next - 1, not yet handed out
+    };
+    MappedFile file;
+    bool binary = false;
+    Array arrays[3];
+    size_t textPos = 0;
+    int line = 0;
+    bool hasHead = false;
+    Obj head;
+
+    bool fetch(Array& a, std::string& err) {
+        if (a.next == a.count) { a.has = false; return true; }
+        const float prevX = a.has ? a.obj.r.x : -INFINITY;
+        const char* at = file.data() + a.offset + (size_t)a.next * a.stride;
+        a.obj.type = a.type;
+        if (a.type == ObjType::JUMP_PAD) {
+            LevelPad pad;
+            std::memcpy(&pad, at, sizeof(pad));
+            a.obj.r = pad.r;
+            a.obj.power = pad.power;
+        } else {
+            std::memcpy(&a.obj.r, at, sizeof(Rect));
+        }
+        ++a.next;
+        a.has = true;
+        if (a.obj.r.x < prevX) { err = "binary level is not sorted by x; convert it again"; return false; }
+        return true;
+    }
+    bool advance(std::string& err) {
+        const float prevX = hasHead ? head.r.x : -INFINITY;
+        hasHead = false;
+        if (binary) {
+            Array* best = nullptr;
+            for (Array& a : arrays)
+                if (a.has && (!best || a.obj.r.x < best->obj.r.x)) best = &a;
+            if (!best) return true;
+            head = best->obj;
+            hasHead = true;
+            return fetch(*best, err);
+        }
+        const std::string_view text(file.data(), file.size());
+        std::vector<Obj> one;
+        while (textPos < text.size()) {
+            size_t nl = text.find('\n', textPos);
+            if (nl == std::string_view::npos) nl = text.size();
+            const std::string_view l = text.substr(textPos, nl - textPos);
+            textPos = nl + 1;
+            ++line;
+            const ParseResult res = parseLevelText(l, one);
+            if (res.error != ParseError::NONE) { err = std::string(parseErrorName(res.error)) + " at line " + std::to_string(line); return false; }
+            if (one.empty()) continue;
+            head = one[0];
+            hasHead = true;
+            if (head.r.x < prevX) { err = "line " + std::to_string(line) + " is out of x order; streaming needs a sorted level"; return false; }
+            return true;
+        }
+        return true;
+    }
+};
+
+// Streaming solve: the level is read a window at a time and the macro written out as it is
+// committed, so memory stays flat however long the level is. Greedy plans up to the end of
+// what is loaded, but a probe that reaches the goal counts as surviving, so only the plan
+// up to STREAM_MARGIN px short of it - beyond the reach of any probe - is committed. The
+// window then slides on by STREAM_AHEAD px, dropping what the player has passed, and
+// greedy replans from the commit point. Committed jumps are final, so a window that
+// cannot be solved from where the last one ended fails the run.
+static bool runStreaming(LevelStream& level, std::ostream& macro, std::string& report, const SolveControl* ctl = nullptr) {
+    std::ostringstream rep;
+    rep << "Streaming run\n";
+    std::vector<Obj> window;
+    std::string err;
+    auto fail = [&](const std::string& why) {
+        rep << why << "\n";
+        report = rep.str();
+        return false;
+    };
+    if (level.done()) return fail("Empty level");
+    float loaded = level.nextX() + STREAM_AHEAD + STREAM_MARGIN;
+    if (!level.readUntil(loaded, window, err)) return fail(err);
+    float endX = -INFINITY;   // right edge of everything read so far
+    for (const Obj& o : window) endX = std::max(endX, o.r.x + o.r.w);
+    float firstGoal = 0.0f;
+    SimState state = levelStart(window, firstGoal);
+    GreedyOptions opt;
+    opt.probeMemo = false;
+    opt.patterns = false;
+    int frame = 0, windows = 0, rescued = 0;
+    size_t peak = window.size();
+    Hold pending{-1, -1};         // last press; it may still be held through a landing
+    bool groundedSince = true;    // as in holdsFromJumps
+    auto emit = [&]() {
+        if (pending.press < 0) return;
+        if (pending.release == pending.press + 1) macro << pending.press << "\n";
+        else macro << pending.press << " " << pending.release << "\n";
+    };
+    for (;;) {
+        const float goal = level.done() ? endX : loaded;
+        const float commitX = level.done() ? endX : loaded - STREAM_MARGIN;
+        std::vector<int> jumps;
+        std::string windowReport;
+        GreedyStats st;
+        if (!runGreedy(window, state, goal, jumps, windowReport, ctl, opt, &st)) {
+            // greedy cannot go back past the commit point, but backtracking inside the window can
+            std::string btReport;
+            if (!runBacktracking(window, state, goal, jumps, btReport, ctl)) {
+                emit();
+                return fail("Window " + std::to_string(windows) + " failed at frame " + std::to_string(frame + st.endFrame) + "\n" + windowReport + btReport);
+            }
+            ++rescued;
+        }
+        ++windows;
+        size_t next = 0;
+        int f = 0;
+        for (; f<MAX_FRAMES && state.px < commitX; ++f) {
+            const bool jump = next < jumps.size() && jumps[next] == f;
+            if (jump) {
+                if (pending.press >= 0 && !groundedSince) pending.release = frame + f + 1;
+                else { emit(); pending = {frame + f, frame + f + 1}; }
+                groundedSince = false;
+                ++next;
+            } else if (state.onGround) {
+                groundedSince = true;
+            }
+            state = stepSim(state, jump, window);
+        }
+        frame += f;
+        macro.flush();
+        if (level.done() && state.px >= endX) break;
+        const float passed = state.px;
+        window.erase(std::remove_if(window.begin(), window.end(), [passed](const Obj& o) { return o.r.x + o.r.w < passed; }), window.end());
+        const size_t before = window.size();
+        loaded = std::max(loaded, state.px + STREAM_MARGIN) + STREAM_AHEAD;
+        if (!level.readUntil(loaded, window, err)) { emit(); return fail(err); }
+        for (size_t i=before; i<window.size(); ++i) endX = std::max(endX, window[i].r.x + window[i].r.w);
+        peak = std::max(peak, window.size());
+    }
+    emit();
+    macro.flush();
+    rep << "Success at frame " << frame << " after " << windows << " windows (" << rescued << " by backtracking), at most " << peak << " objects loaded\n";
+    report = rep.str();
+    return true;
+}
+
+#ifndef PATHFINDER_HEADLESS
+// safe live extractor: attempt PlayLayer->m_level->m_objects guardedly; if not possible, return false
+static bool extractLive(LevelSnapshot& snap, std::vector<Obj>& out, std::string& dbg) {
+    out.clear();
+    snap.resize(0);
+    dbg.clear();
+    PlayLayer* pl = nullptr;
+    try { pl = PlayLayer::get(); } catch(...) { pl = nullptr; }
+    if (!pl) { dbg = "PlayLayer not found"; return false; }
+    GJGameLevel* level = nullptr;
+    try { level = pl->m_level; } catch(...) { level = nullptr; }
+    if (!level) { dbg = "level ptr not found"; return false; }
+    cocos2d::CCArray* arr = nullptr;
+    try { arr = level->m_objectList; } catch(...) { arr = nullptr; }
+    if (!arr) {
+        try { arr = level->m_objects; } catch(...) { arr = nullptr; }
+    }
+    if (!arr) {
+        try { arr = level->m_objectArray; } catch(...) { arr = nullptr; }
+    }
+    if (!arr) { dbg = "objects array not found"; return false; }
+    // one pass over the array, straight into the snapshot's columns; decoration is dropped here
+    const unsigned count = arr->count();
+    snap.resize(count);
+    size_t n = 0;
+    for (unsigned i=0; i<count; ++i) {
+        GameObject* go = static_cast<GameObject*>(arr->objectAtIndex(i));
+        if (!go || classifyGDObject(go->m_objectID).category == GDCategory::DECORATION) continue;
+        const cocos2d::CCRect hit = go->getObjectRect();
+        snap.id[n] = go->m_objectID;
+        snap.x[n] = go->m_x;
+        snap.y[n] = go->m_y;
+        snap.rotation[n] = go->getRotation();
+        snap.scaleX[n] = go->getScaleX();
+        snap.scaleY[n] = go->getScaleY();
+        snap.group[n] = go->m_groups && go->m_groupCount > 0 ? (*go->m_groups)[0] : 0;
+        snap.hitX[n] = hit.origin.x;
+        snap.hitY[n] = hit.origin.y;
+        snap.hitW[n] = hit.size.width;
+        snap.hitH[n] = hit.size.height;
+        snap.flags[n] = go->isFlipY() ? SNAPSHOT_FLIP_Y : 0;
+        ++n;
+    }
+    snap.resize(n);
+    const ParseResult res = snap.toObjects(out);
+    dbg = "extracted " + std::to_string(out.size()) + " objects; dropped " + std::to_string(count - n) + " decorations, "
+          + std::to_string(res.ignored) + " orbs and portals";
+    return !out.empty();
+}
+
+class PathfinderPopup : public FLAlertLayerProtocol {
+public:
+    std::filesystem::path saveDir;
+    PathfinderPopup() {
+        try { saveDir = Mod::get()->getSaveDir(); } catch(...) { saveDir = std::filesystem::current_path(); }
+    }
+    void show() {
+        std::ostringstream ss;
+        ss << "Pathfinder (single-file)\\n\\n";
+        ss << "Press RUN to attempt live extraction (PlayLayer). If that fails, fallback to level.txt.\\n\\n";
+        ss << "Save dir: " << saveDir.string() << "\\n\\n";
+        ss << "Create level.txt in the save dir if needed. Format: PLATFORM,x,y,w,h  SPIKE,x,y,w,h  JUMP_PAD,x,y,w[,power]\\n\\n";
+        ss << "Press RUN to start.";
+        FLAlertLayer::create(this, "Pathfinder", ss.str(), "RUN", "CANCEL")->show();
+    }
+    void FLAlert_Clicked(FLAlertLayer*, int btn) override {
+        if (btn==0) run();
+    }
+    void run() {
+        std::vector<Obj> objs;
+        LevelSnapshot snap;
+        std::string dbg;
+        bool ok = extractLive(snap, objs, dbg);
+        if (ok) {
+            // keep what was extracted for replaying offline with pathfinder-cli
+            std::string err;
+            if (!snap.save(Mod::get()->getSaveDir() / "live.pfs", err))
+                GEODE_ERROR("[Pathfinder] %s", err.c_str());
+        } else {
+            // try file fallback, a binary level.pfl first
+            auto p = (Mod::get()->getSaveDir() / "level.pfl");
+            if (!std::filesystem::exists(p)) p = (Mod::get()->getSaveDir() / "level.txt");
+            std::string filedbg;
+            if (!parseLevelFile(p, objs, filedbg)) {
+                std::ostringstream oss;
+                oss << "Pathfinder: failed to read level. live: " << dbg << " file: " << filedbg;
+                geode::Notification::create(oss.str(), geode::NotificationIcon::Exclamation, 6.0f)->show();
+                // write report
+                auto report = (Mod::get()->getSaveDir() / "pathfinder_report.txt");
+                std::ofstream rf(report.string(), std::ios::trunc);
+                rf << "live debug:\\n" << dbg << "\\nfile debug:\\n" << filedbg << "\\n";
+                rf.close();
+                GEODE_ERROR("[Pathfinder] extraction failed: %s | %s", dbg.c_str(), filedbg.c_str());
+                return;
+            }
+        }
+        float maxX = 0.0f;
+        SimState start = levelStart(objs, maxX);
+        auto saveDir = Mod::get()->getSaveDir();
+        // optional pattern library from `pathfinder-cli train`; loaded before the first solve only
+        static std::once_flag patternsOnce;
+        std::call_once(patternsOnce, [&saveDir]() {
+            std::string err;
+            if (std::filesystem::exists(saveDir / "patterns.pfp") && !PatternLibrary::get().load(saveDir / "patterns.pfp", err))
+                GEODE_ERROR("[Pathfinder] pattern library: %s", err.c_str());
+        });
+        auto solver = AnytimeSolver::start(objs, start, maxX, ANYTIME_BUDGET, [saveDir, dbg, objs](const AnytimeResult& res) {
+            Loader::get()->queueInMainThread([saveDir, dbg, objs, res]() { writeOutputs(saveDir, dbg, objs, res); });
+        }, speculativeWorkers());
+        // first answer right away; the final one is written when the solve finishes
+        AnytimeResult first = solver->waitFirst(ANYTIME_FIRST_ANSWER);
+        if (!first.finished) writeOutputs(saveDir, dbg, objs, first);
+    }
+
+    static void writeOutputs(const std::filesystem::path& saveDir, const std::string& dbg, const std::vector<Obj>& objs, const AnytimeResult& res) {
+        auto reportPath = (saveDir / "pathfinder_report.txt");
+        try {
+            std::ofstream rf(reportPath.string(), std::ios::trunc);
+            rf << "extraction debug:\n" << dbg << "\n";
+            rf << res.report << "\n";
+            if (!res.finished) rf << "(solve still running; this report will be replaced)\n";
+            rf << "objects:\n";
+            for (auto &o : objs) {
+                rf << (o.type==ObjType::PLATFORM?"PLATFORM":o.type==ObjType::SPIKE?"SPIKE":"JUMP_PAD") << ","
+                   << o.r.x << "," << o.r.y << "," << o.r.w << "," << o.r.h << "\n";
+            }
+            rf.close();
+        } catch(...) {
+            GEODE_ERROR("[Pathfinder] failed to write report file");
+        }
+        if (res.jumps.empty() && !res.complete && (res.finished || res.stage == "none")) {
+            if (res.finished)
+                geode::Notification::create("Pathfinder: couldn't find safe macro. See pathfinder_report.txt", geode::NotificationIcon::Exclamation, 6.0f)->show();
+            else
+                geode::Notification::create("Pathfinder: still solving...", geode::NotificationIcon::Loading, 3.0f)->show();
+            return;
+        }
+        try {
+            auto macroPath = (saveDir / "macro.txt").string();
+            std::ofstream mf(macroPath, std::ios::trunc);
+            writeMacro(mf, res.holds);
+            mf.close();
+            std::ostringstream msg;
+            msg << "Pathfinder: wrote macro.txt (" << res.jumps.size() << " jumps in " << res.holds.size() << " presses, " << res.stage << ")";
+            if (!res.complete) msg << " - partial, reaches x=" << (int)res.reachedX;
+            if (!res.finished) msg << ", still refining";
+            geode::Notification::create(msg.str(), res.complete ? geode::NotificationIcon::Check : geode::NotificationIcon::Exclamation, 6.0f)->show();
+            GEODE_INFO("[Pathfinder] wrote macro: %s", macroPath.c_str());
+        } catch(...) {
+            geode::Notification::create("Pathfinder: failed to write macro.txt", geode::NotificationIcon::Exclamation, 6.0f)->show();
+        }
+    }
+};
+
+class $modify(MenuLayer) {
+    void onMoreGames(CCObject* sender) {
+        MenuLayer::onMoreGames(sender);
+        try {
+            PathfinderPopup p;
+            p.show();
+        } catch(...) {
+            GEODE_ERROR("[Pathfinder] exception showing popup");
+        }
+    }
+};
+
+#else
+
+// Whole-file reads and writes for batch runs, kept in flight off the solver threads. On
+// Linux one thread drives an io_uring with up to IO_DEPTH requests outstanding; where the
+// kernel has no usable ring, IO_POOL_THREADS blocking threads work the same queue.
+// Read callbacks run on an I/O thread and should only hand the data on.
+class FileIO {
+public:
+    using ReadDone = std::function<void(std::string data, bool ok)>;
+
+    FileIO() = default;
+    FileIO(const FileIO&) = delete;
+    FileIO& operator=(const FileIO&) = delete;
+    ~FileIO() { finish(); }
+
+    void start(bool allowRing) {
+#ifdef PATHFINDER_IO_URING
+        if (allowRing && setupRing()) {
+            ring = true;
+            threads.emplace_back([this] { runRing(); });
+            return;
+        }
+#else
+        (void)allowRing;
+#endif
+        for (int t=0; t<IO_POOL_THREADS; ++t) threads.emplace_back([this] { runPool(); });
+    }
+    const char* backend() const { return ring ? "io_uring" : "thread pool"; }
+
+    void read(const std::filesystem::path& p, ReadDone done) { push(false, p, {}, std::move(done)); }
+    void write(const std::filesystem::path& p, std::string data) { push(true, p, std::move(data), nullptr); }
+    int failedWrites() const { return writeFailures; }
+
+    // Waits for every request made so far, then stops the I/O threads.
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        wake();
+        for (auto& th : threads) th.join();
+        threads.clear();
+#ifdef PATHFINDER_IO_URING
+        if (ringFd >= 0) {
+            munmap(sqRing, sqRingSize);
+            if (cqRing != sqRing) munmap(cqRing, cqRingSize);
+            munmap(sqes, sqesSize);
+            ::close(ringFd);
+            ::close(wakeFd);
+            ringFd = wakeFd = -1;
+        }
+#endif
+    }
+
+private:
+    struct Request {
+        bool write;
+        std::string path, data;
+        ReadDone done;
+        int fd = -1;
+        size_t pos = 0;
+    };
+
+    void push(bool write, const std::filesystem::path& p, std::string data, ReadDone done) {
+        auto req = std::make_unique<Request>();
+        req->write = write;
+        req->path = p.string();
+        req->data = std::move(data);
+        req->done = std::move(done);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            pending.push_back(std::move(req));
+        }
+        wake();
+    }
+    void wake() {
+#ifdef PATHFINDER_IO_URING
+        if (ringFd >= 0) {
+            const uint64_t one = 1;
+            if (::write(wakeFd, &one, sizeof one) < 0) {}   // a full counter wakes the ring anyway
+            return;
+        }
+#endif
+        cv.notify_all();
+    }
+    void complete(std::unique_ptr<Request> req, bool ok) {
+#if defined(__unix__) || defined(__APPLE__)
+        if (req->fd >= 0) ::close(req->fd);
+#endif
+        if (req->write) {
+            if (!ok) ++writeFailures;
+        } else {
+            if (!ok) req->data.clear();
+            req->done(std::move(req->data), ok);
+        }
+    }
+
+    void runPool() {
+        for (;;) {
+            std::unique_ptr<Request> req;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return stopping || !pending.empty(); });
+                if (pending.empty()) return;
+                req = std::move(pending.front());
+                pending.pop_front();
+            }
+            bool ok;
+            if (req->write) {
+                std::ofstream f(req->path, std::ios::binary | std::ios::trunc);
+                ok = bool(f.write(req->data.data(), (std::streamsize)req->data.size()));
+            } else {
+                std::ifstream f(req->path, std::ios::binary | std::ios::ate);
+                ok = bool(f);
+                if (ok) {
+                    req->data.resize((size_t)f.tellg());
+                    f.seekg(0);
+                    ok = bool(f.read(&req->data[0], (std::streamsize)req->data.size()));
+                }
+            }
+            complete(std::move(req), ok);
+        }
+    }
+
+#ifdef PATHFINDER_IO_URING
+    // The ring is driven with raw system calls. Each request opens its file, then reads or
+    // writes it whole, resubmitting after short transfers; user_data is the Request, or 0
+    // for the eventfd read that wakes the ring when work is pushed.
+    bool setupRing() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof params);
+        const int fd = (int)syscall(__NR_io_uring_setup, IO_DEPTH + 1, &params);
+        if (fd < 0) return false;
+        // OPENAT, READ and WRITE arrived together (Linux 5.6) with the probe itself
+        std::vector<uint8_t> probeBuf(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        io_uring_probe* probe = (io_uring_probe*)probeBuf.data();
+        bool usable = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+        for (int op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE})
+            usable = usable && op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        if (usable) {
+            sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+            if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+            sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+            sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            cqRing = single ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            void* sqeMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            wakeFd = eventfd(0, EFD_CLOEXEC);
+            usable = sqRing != MAP_FAILED && cqRing != MAP_FAILED && sqeMap != MAP_FAILED && wakeFd >= 0;
+            if (usable) {
+                char* sq = (char*)sqRing;
+                char* cq = (char*)cqRing;
+                sqHead = (unsigned*)(sq + params.sq_off.head);
+                sqTail = (unsigned*)(sq + params.sq_off.tail);
+                sqMask = *(unsigned*)(sq + params.sq_off.ring_mask);
+                sqArray = (unsigned*)(sq + params.sq_off.array);
+                sqes = (io_uring_sqe*)sqeMap;
+                cqHead = (unsigned*)(cq + params.cq_off.head);
+                cqTail = (unsigned*)(cq + params.cq_off.tail);
+                cqMask = *(unsigned*)(cq + params.cq_off.ring_mask);
+                cqes = (io_uring_cqe*)(cq + params.cq_off.cqes);
+            } else {
+                if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+                if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+                if (sqeMap != MAP_FAILED) munmap(sqeMap, sqesSize);
+                if (wakeFd >= 0) ::close(wakeFd);
+                wakeFd = -1;
+            }
+        }
+        if (!usable) {
+            ::close(fd);
+            return false;
+        }
+        ringFd = fd;
+        return true;
+    }
+    // Queued for the next io_uring_enter; the ring always has room, as at most IO_DEPTH
+    // requests and the wake read are outstanding.
+    io_uring_sqe* nextSqe() {
+        const unsigned tail = *sqTail;
+        const unsigned index = tail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof *sqe);
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++unsubmitted;
+        return sqe;
+    }
+    void submitOpen(Request* req) {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)req->path.c_str();
+        sqe->len = 0644;
+        sqe->open_flags = req->write ? O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC;
+        sqe->user_data = (uint64_t)(uintptr_t)req;
+    }
+    void submitTransfer(Request* req) {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = req->write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = req->fd;
+        sqe->addr = (uint64_t)(uintptr_t)(&req->data[0] + req->pos);
+        sqe->len = (unsigned)std::min<size_t>(req->data.size() - req->pos, 1u << 30);
+        sqe->off = req->pos;
+        sqe->user_data = (uint64_t)(uintptr_t)req;
+    }
+    void submitWake() {
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = wakeFd;
+        sqe->addr = (uint64_t)(uintptr_t)&wakeCount;
+        sqe->len = sizeof wakeCount;
+        sqe->user_data = 0;
+    }
+    // An open or a transfer finished with result res; true when the request goes on.
+    bool advance(Request* req, int res) {
+        std::unique_ptr<Request> owned(req);
+        if (res < 0) {
+            complete(std::move(owned), false);
+            return false;
+        }
+        if (req->fd < 0) {
+            req->fd = res;
+            if (!req->write) {
+                struct stat st;
+                if (fstat(req->fd, &st) != 0) {
+                    complete(std::move(owned), false);
+                    return false;
+                }
+                req->data.resize((size_t)st.st_size);
+            }
+        } else if (res == 0) {
+            // a file that shrank since the open is read as far as it goes
+            if (req->write) {
+                complete(std::move(owned), false);
+                return false;
+            }
+            req->data.resize(req->pos);
+        } else {
+            req->pos += (size_t)res;
+        }
+        if (req->pos == req->data.size()) {
+            complete(std::move(owned), true);
+            return false;
+        }
+        submitTransfer(owned.release());
+        return true;
+    }
+    void runRing() {
+        submitWake();
+        int inflight = 0;
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(m);
+                while (inflight < (int)IO_DEPTH && !pending.empty()) {
+                    submitOpen(pending.front().release());
+                    pending.pop_front();
+                    ++inflight;
+                }
+                if (stopping && pending.empty() && inflight == 0) return;
+            }
+            const int n = (int)syscall(__NR_io_uring_enter, ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (n < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                std::cerr << "io_uring_enter failed: " << std::strerror(errno) << "\n";
+                std::abort();
+            }
+            if (n > 0) unsubmitted -= (unsigned)n;
+            unsigned head = *cqHead;
+            const unsigned tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head) {
+                const io_uring_cqe cqe = cqes[head & cqMask];
+                __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+                if (cqe.user_data == 0) {
+                    submitWake();
+                    continue;
+                }
+                if (!advance((Request*)(uintptr_t)cqe.user_data, cqe.res)) --inflight;
+            }
+        }
+    }
+
+    int ringFd = -1, wakeFd = -1;
+    void* sqRing = nullptr;
+    void* cqRing = nullptr;
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0, unsubmitted = 0;
+    io_uring_sqe* sqes = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+    uint64_t wakeCount = 0;
+#else
+    int ringFd = -1;
+#endif
+
+    bool ring = false;
+    std::vector<std::thread> threads;
+    std::deque<std::unique_ptr<Request>> pending;
+    bool stopping = false;
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<int> writeFailures{0};
+};
+
+// Headless entry point for offline use:
+//   pathfinder-cli solve <level.txt> [out dir]   anytime solve, writes macro.txt and pathfinder_report.txt
+//   pathfinder-cli bench <level.txt>...          planner variants: stepSim calls, probes per decision, solve rate
+//   pathfinder-cli train <out.pfp> <level.txt>... build a pattern library from solved levels
+//   pathfinder-cli check [level.txt...]          solver regressions: backtracking solves what greedy does
+//   pathfinder-cli parse <level.txt>...          level parser throughput in MB/s
+//   pathfinder-cli convert <level.txt> <out.pfl>  write a binary level
+//   pathfinder-cli pack <out.pfk> <level.txt>...  write a level pack
+//   pathfinder-cli import <CCLocalLevels.dat | levels.pfk> [out dir] [threads]  solve every level in a GD save or pack
+//   pathfinder-cli stream <level.pfl> [out dir]  solve in a sliding window with flat memory
+//   pathfinder-cli batch [--pool-io] [--threads n] <out dir> <level, pack or dir>...  solve many levels
+// Every command that reads a level also accepts a binary level.
+// solve and bench take --patterns <library.pfp> first to load a library.
+static int cliSolve(const std::filesystem::path& levelPath, const std::filesystem::path& outDir) {
+    std::vector<Obj> objs;
+    std::string dbg;
+    if (!parseLevelFile(levelPath, objs, dbg)) {
+        std::cerr << "failed to read " << levelPath.string() << ": " << dbg << "\n";
+        return 1;
+    }
+    float goalX = 0.0f;
+    SimState start = levelStart(objs, goalX);
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    if (ec) {
+        std::cerr << outDir.string() << ": " << ec.message() << "\n";
+        return 1;
+    }
+    auto solver = AnytimeSolver::start(objs, start, goalX, ANYTIME_BUDGET, nullptr, speculativeWorkers());
+    AnytimeResult res = solver->waitFinished();
+    std::ofstream rf((outDir / "pathfinder_report.txt").string(), std::ios::trunc);
+    rf << "parse debug:\n" << dbg << "\n" << res.report;
+    // the presses must take off exactly where the planner jumped
+    if (jumpsFromHolds(objs, start, goalX, res.holds) != res.jumps) rf << "warning: presses do not replay to the planned jumps\n";
+    rf.close();
+    std::ofstream mf((outDir / "macro.txt").string(), std::ios::trunc);
+    writeMacro(mf, res.holds);
+    mf.close();
+    std::cout << levelPath.string() << ": " << (res.complete ? "solved" : "partial") << " by " << res.stage
+              << ", " << res.jumps.size() << " jumps in " << res.holds.size() << " presses\n";
+    if (!rf || !mf) {
+        std::cerr << "cannot write macro.txt or pathfinder_report.txt in " << outDir.string() << "\n";
+        return 1;
+    }
+    return res.complete ? 0 : 2;
+}
+
+static int cliBench(int count, char** paths) {
+    struct Variant { const char* name; GreedyOptions opt; Solver solver; };   // solver replaces runGreedy when set
+    const Variant variants[] = {
+        {"fixed", {false, false, false, false}, nullptr},
+        {"adaptive", {true, false, false, false}, nullptr},
+        {"ordered", {true, true, false, false}, nullptr},
+        {"memo", {true, true, true, false}, nullptr},
+        {"library", {true, true, true, true}, nullptr},
+        {"speculative", {true, true, true, true, true, speculativeWorkers()}, nullptr},
+        {"coarse", {}, runCoarseToFine},
+        {"intervals", {}, runIntervalSolver},
+        {"portfolio", {}, runPortfolio},
+    };
+    const int nv = (int)(sizeof(variants) / sizeof(variants[0]));
+    struct Level { std::string name; std::vector<Obj> objs; SimState start; float goalX = 0.0f; };
+    std::vector<Level> levels;
+    for (int i=0; i<count; ++i) {
+        Level l;
+        std::string dbg;
+        if (!parseLevelFile(paths[i], l.objs, dbg)) {
+            std::cerr << "skipping " << paths[i] << ": " << dbg << "\n";
+            continue;
+        }
+        l.name = std::filesystem::path(paths[i]).filename().string();
+        l.start = levelStart(l.objs, l.goalX);
+        levels.push_back(std::move(l));
+    }
+    struct Run { bool ok = false; unsigned long long calls = 0; GreedyStats st; double ms = 0.0; std::vector<int> jumps; };
+    std::vector<std::vector<Run>> runs(nv, std::vector<Run>(levels.size()));
+    // one variant at a time over the whole corpus, each starting from an empty probe memo,
+    // so memo reuse across levels is counted but never leaks between variants
+    for (int v=0; v<nv; ++v) {
+        ProbeMemo::get().clear();
+        for (size_t i=0; i<levels.size(); ++i) {
+            const Level& l = levels[i];
+            Run& r = runs[v][i];
+            std::vector<int>& jumps = r.jumps;
+            std::string report;
+            stepCalls = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            if (variants[v].solver) r.ok = variants[v].solver(l.objs, l.start, l.goalX, jumps, report, nullptr);
+            else r.ok = runGreedy(l.objs, l.start, l.goalX, jumps, report, nullptr, variants[v].opt, &r.st);
+            r.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            r.calls = stepCalls;
+        }
+    }
+    std::cout << std::left << std::setw(24) << "level";
+    for (auto const& v : variants) std::cout << " | " << std::setw(9) << v.name << " ok     stepSim  probes/dec        ms";
+    std::cout << "\n";
+    for (size_t i=0; i<levels.size(); ++i) {
+        std::cout << std::left << std::setw(24) << levels[i].name;
+        for (int v=0; v<nv; ++v) {
+            const Run& r = runs[v][i];
+            std::cout << " | " << std::right << std::setw(12) << (r.ok ? "yes" : "no") << std::setw(12) << r.calls
+                      << std::setw(12) << std::fixed << std::setprecision(2) << (r.st.decisions ? (double)r.st.probes / r.st.decisions : 0.0)
+                      << std::setw(10) << std::setprecision(1) << r.ms << std::left;
+        }
+        std::cout << "\n";
+    }
+    std::vector<double> totalMs(nv, 0.0);
+    for (int v=0; v<nv; ++v) {
+        int solved = 0;
+        unsigned long long calls = 0;
+        GreedyStats st;
+        for (const Run& r : runs[v]) {
+            solved += r.ok;
+            calls += r.calls;
+            totalMs[v] += r.ms;
+            st.decisions += r.st.decisions;
+            st.probes += r.st.probes;
+            st.patternLookups += r.st.patternLookups;
+            st.patternHits += r.st.patternHits;
+        }
+        std::cout << std::setw(9) << variants[v].name << ": solved " << solved << "/" << levels.size()
+                  << ", stepSim calls " << calls << ", probes/decision "
+                  << std::setprecision(2) << (st.decisions ? (double)st.probes / st.decisions : 0.0)
+                  << ", " << std::setprecision(1) << totalMs[v] << " ms";
+        if (!variants[v].solver && variants[v].opt.patterns && PatternLibrary::get().loaded()) {
+            std::cout << ", library hits " << st.patternHits << "/" << st.patternLookups;
+            if (st.patternLookups) std::cout << " (" << 100.0 * st.patternHits / st.patternLookups << "%)";
+            std::cout << ", " << totalMs[v - 1] - totalMs[v] << " ms saved vs " << variants[v - 1].name;
+        }
+        if (variants[v].opt.speculate) {
+            // same options inline must give the same macro
+            int same = 0;
+            for (size_t i=0; i<levels.size(); ++i) same += runs[v][i].jumps == runs[v - 1][i].jumps;
+            std::cout << ", " << variants[v].opt.workers << " workers, " << (totalMs[v] > 0.0 ? totalMs[v - 1] / totalMs[v] : 0.0)
+                      << "x vs " << variants[v - 1].name << ", same macro on " << same << "/" << levels.size();
+        }
+        std::cout << "\n";
+    }
+    PortfolioStats& ps = PortfolioStats::get();
+    if (ps.races) {
+        std::cout << "portfolio wins over " << ps.races << " races:";
+        for (auto const& w : ps.wins) std::cout << " " << w.first << " " << w.second;
+        std::cout << "\n";
+    }
+    return 0;
+}
+
+// Harvest library patterns from a verified macro: for every hazard, the takeoffs inside
+// its cluster window, keyed on the ground the first of them leaves from.
+static void collectPatterns(const std::vector<Obj>& objs, SimState start, const std::vector<int>& jumps,
+                            std::map<std::pair<uint64_t, std::vector<int16_t>>, uint16_t>& seen) {
+    HorizonInfo info(objs);
+    std::vector<SimState> takeoffs;
+    SimState s = start;
+    int frame = 0;
+    for (int j : jumps) {
+        for (; frame < j; ++frame) s = stepSim(s, false, objs);
+        takeoffs.push_back(s);
+        s = stepSim(s, true, objs);
+        ++frame;
+    }
+    for (size_t h=0; h<info.hazardX.size(); ++h) {
+        const float hx = info.hazardX[h];
+        if (h > 0 && info.hazardX[h - 1] == hx) continue;
+        std::vector<int16_t> offsets;
+        float groundY = 0.0f;
+        for (const SimState& t : takeoffs) {
+            if (t.px < hx - PATTERN_LEAD || t.px >= hx + PATTERN_SPAN) continue;
+            if (offsets.empty()) groundY = t.py;
+            offsets.push_back((int16_t)std::lround((t.px - hx) * 4.0f));
+        }
+        if (offsets.empty() || offsets.size() > (size_t)PATTERN_MAX_JUMPS) continue;
+        uint16_t& n = seen[{PatternLibrary::key(objs, info, hx, groundY), offsets}];
+        if (n < UINT16_MAX) ++n;
+    }
+}
+
+// Levels for `pathfinder-cli check`: obstacle runs over a tiled floor, in the mix the
+// backtracking regression needs: raised blocks, blocks ending in a spike, and one to three
+// spikes in a row.
+static std::vector<Obj> generatedLevel(unsigned seed, float length) {
+    std::mt19937 rng(seed);
+    auto pick = [&](int lo, int hi) { return std::uniform_int_distribution<int>(lo, hi)(rng); };
+    auto add = [](std::vector<Obj>& objs, ObjType type, float x, float y, float w, float h) {
+        Obj o;
+        o.type = type;
+        o.r = {x, y, w, h};
+        objs.push_back(o);
+    };
+    std::vector<Obj> objs;
+    for (float x=0.0f; x<length; x+=30.0f) add(objs, ObjType::PLATFORM, x, 0, 30, 30);
+    for (float x=300.0f; x<length-400.0f;) {
+        const int kind = pick(0, 19);
+        if (kind < 3) {
+            add(objs, ObjType::PLATFORM, x, 30, 60, 30);
+            x += 60.0f + pick(150, 400);
+        } else if (kind < 5) {
+            add(objs, ObjType::PLATFORM, x, 30, 90, 30);
+            add(objs, ObjType::SPIKE, x + 90.0f, 30, 30, 30);
+            x += 120.0f + pick(120, 300);
+        } else {
+            const int spikes = pick(1, 3);
+            for (int i=0; i<spikes; ++i) add(objs, ObjType::SPIKE, x + i * 30.0f, 30, 30, 30);
+            x += 140.0f + pick(0, 300);
+        }
+    }
+    return objs;
+}
+
+// pathfinder-cli check: solver invariants over the given levels, or CHECK_LEVELS generated
+// ones (and a lone triple spike) with none given. Every level greedy solves, stepping each
+// probe, runBacktracking must solve too, with a macro that replays.
+static int cliCheck(int count, char** paths) {
+    struct Level { std::string name; std::vector<Obj> objs; };
+    std::vector<Level> levels;
+    for (int i=0; i<count; ++i) {
+        Level l{paths[i], {}};
+        std::string dbg;
+        if (!parseLevelFile(paths[i], l.objs, dbg)) {
+            std::cerr << "failed to read " << paths[i] << ": " << dbg << "\n";
+            return 1;
+        }
+        levels.push_back(std::move(l));
+    }
+    if (count == 0) {
+        Level triple{"triple spike", {}};
+        triple.objs.push_back({ObjType::PLATFORM, {0, 0, 2000, 30}, 0.0f});
+        for (int i=0; i<3; ++i) triple.objs.push_back({ObjType::SPIKE, {400.0f + i * 30.0f, 30, 30, 30}, 0.0f});
+        levels.push_back(std::move(triple));
+        for (int i=0; i<CHECK_LEVELS; ++i) levels.push_back({"generated " + std::to_string(i), generatedLevel(100 + i, 3000.0f + i * 300.0f)});
+    }
+    int greedySolved = 0, failures = 0;
+    for (const Level& l : levels) {
+        float goalX = 0.0f;
+        const SimState start = levelStart(l.objs, goalX);
+        GreedyOptions exact;
+        exact.probeMemo = false;
+        exact.patterns = false;
+        std::vector<int> jumps;
+        std::string report;
+        if (!runGreedy(l.objs, start, goalX, jumps, report, nullptr, exact)) continue;
+        ++greedySolved;
+        int failFrame = 0;
+        if (runBacktracking(l.objs, start, goalX, jumps, report) && verifyMacro(l.objs, start, goalX, jumps, failFrame)) continue;
+        ++failures;
+        std::cout << l.name << ": greedy solves it, backtracking does not\n" << report;
+    }
+    std::cout << levels.size() << " levels, " << greedySolved << " solved by greedy, " << failures << " not by backtracking\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// pathfinder-cli train: solve each level, keep verified macros, and write the most
+// common takeoff sequence per cluster key.
+static int cliTrain(const std::filesystem::path& outPath, int count, char** paths) {
+    if (outPath.extension() != ".pfp") {
+        std::cerr << "pattern libraries are written as .pfp, not " << outPath.string() << "\n";
+        return 64;
+    }
+    std::map<std::pair<uint64_t, std::vector<int16_t>>, uint16_t> seen;
+    int used = 0;
+    for (int i=0; i<count; ++i) {
+        std::vector<Obj> objs;
+        std::string dbg;
+        if (!parseLevelFile(paths[i], objs, dbg)) {
+            std::cerr << "skipping " << paths[i] << ": " << dbg << "\n";
+            continue;
+        }
+        float goalX = 0.0f;
+        SimState start = levelStart(objs, goalX);
+        std::vector<int> jumps;
+        std::string report;
+        int failFrame = 0;
+        if (!runPathfinder(objs, start, goalX, jumps, report) && !runBacktracking(objs, start, goalX, jumps, report)) continue;
+        if (!verifyMacro(objs, start, goalX, jumps, failFrame)) continue;
+        collectPatterns(objs, start, jumps, seen);
+        ++used;
+    }
+    std::vector<PatternRecord> recs;
+    for (auto const& e : seen) {
+        const uint64_t key = e.first.first;
+        const std::vector<int16_t>& offsets = e.first.second;
+        if (!recs.empty() && recs.back().key == key) {
+            if (e.second <= recs.back().weight) continue;   // keep the most common sequence
+            recs.pop_back();
+        }
+        PatternRecord r{};
+        r.key = key;
+        r.jumps = (uint16_t)offsets.size();
+        std::copy(offsets.begin(), offsets.end(), r.offsets);
+        r.weight = e.second;
+        recs.push_back(r);
+    }
+    std::string err;
+    if (!PatternLibrary::save(outPath, recs, err)) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+    std::cout << outPath.string() << ": " << recs.size() << " patterns from " << used << "/" << count << " solved levels\n";
+    return 0;
+}
+
+// pathfinder-cli parse: level parser throughput. Every file is mapped and parsed again
+// until PARSE_BENCH_BYTES have gone through, once counting the mapping and once over
+// text that is already mapped; then the text parser alone at 1, 2, 4... threads.
+static int cliParse(int count, char** paths) {
+    using clock = std::chrono::steady_clock;
+    std::vector<std::unique_ptr<MappedFile>> files;
+    size_t bytes = 0;
+    for (int i=0; i<count; ++i) {
+        auto f = std::make_unique<MappedFile>();
+        std::string err;
+        std::vector<Obj> objs;
+        const ParseResult res = parseLevelFile(paths[i], objs);
+        if (res.error != ParseError::NONE || !f->open(paths[i], err)) {
+            std::cerr << paths[i] << ": " << parseErrorName(res.error);
+            if (res.line > 0) std::cerr << " at line " << res.line;
+            std::cerr << "\n";
+            return 1;
+        }
+        std::cout << paths[i] << ": " << objs.size() << " objects, " << f->size() << " bytes\n";
+        bytes += f->size();
+        files.push_back(std::move(f));
+    }
+    if (bytes == 0) {
+        std::cerr << "nothing to parse\n";
+        return 1;
+    }
+    const size_t rounds = std::max<size_t>(1, PARSE_BENCH_BYTES / bytes);
+    std::vector<Obj> objs;
+    size_t parsed = 0;
+    auto t0 = clock::now();
+    for (size_t r=0; r<rounds; ++r)
+        for (int i=0; i<count; ++i) {
+            parseLevelFile(paths[i], objs);
+            parsed += objs.size();
+        }
+    const double mapMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    t0 = clock::now();
+    for (size_t r=0; r<rounds; ++r)
+        for (auto const& f : files) {
+            parseLevelBytes(std::string_view(f->data(), f->size()), objs);
+            parsed += objs.size();
+        }
+    const double textMs = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    const double mb = (double)bytes * rounds / 1e6;
+    std::cout << std::fixed << std::setprecision(1)
+              << "map + parse: " << mb / (mapMs / 1000.0) << " MB/s (" << mapMs << " ms for " << mb << " MB)\n"
+              << "parse only : " << mb / (textMs / 1000.0) << " MB/s (" << textMs << " ms), " << parsed / 2 / rounds << " objects per round\n";
+    // scaling of the text parser with threads, over the text files
+    std::vector<std::string_view> texts;
+    size_t textBytes = 0;
+    for (auto const& f : files) {
+        const std::string_view b(f->data(), f->size());
+        if (isBinaryLevel(b) || LevelDecoder::looksEncoded(b)) continue;
+        texts.push_back(b);
+        textBytes += b.size();
+    }
+    const int hw = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int threads=1; !texts.empty(); threads = threads < hw && threads * 2 > hw ? hw : threads * 2) {
+        const size_t n = std::max<size_t>(1, PARSE_BENCH_BYTES / textBytes);
+        t0 = clock::now();
+        for (size_t r=0; r<n; ++r)
+            for (std::string_view t : texts) parseLevelTextParallel(t, objs, threads);
+        const double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        std::cout << "text, " << std::setw(3) << threads << " threads: " << (double)textBytes * n / 1e6 / (ms / 1000.0) << " MB/s\n";
+        if (threads >= hw) break;
+    }
+    return 0;
+}
+
+// pathfinder-cli import: solve every level in a GD save file or a level pack. The main
+// thread streams the levels out of the save (or just their indices out of the pack) into a
+// bounded queue; workers decode and solve them and write <index>.pfl and <index>_macro.txt
+// to the out dir. With --no-solve levels are only decoded.
+static int cliImport(int argc, char** argv) {
+    bool solve = true;
+    if (argc > 0 && std::string(argv[0]) == "--no-solve") { solve = false; ++argv; --argc; }
+    if (argc < 1) {
+        std::cerr << "import needs a save file or level pack\n";
+        return 64;
+    }
+    const std::filesystem::path savePath = argv[0], outDir = argc >= 2 ? argv[1] : ".";
+    const int nThreads = argc >= 3 ? std::max(1, std::atoi(argv[2])) : (int)std::max(1u, std::thread::hardware_concurrency());
+    LevelPack pack;
+    std::string err;
+    const bool isPack = LevelPack::isPack(savePath);
+    if (isPack && !pack.open(savePath, err)) {
+        std::cerr << savePath.string() << ": " << err << "\n";
+        return 1;
+    }
+    if (solve) {
+        std::error_code ec;
+        std::filesystem::create_directories(outDir, ec);
+        if (ec) {
+            std::cerr << outDir.string() << ": " << ec.message() << "\n";
+            return 1;
+        }
+    }
+    struct Job { int index; std::string name, data; };   // data is empty for packs
+    std::deque<Job> queue;
+    bool done = false;
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<int> decoded{0}, solved{0}, failed{0}, failedWrites{0};
+    std::atomic<long long> objects{0};
+    auto worker = [&]() {
+        LevelDecoder decoder;
+        std::vector<Obj> objs;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return done || !queue.empty(); });
+                if (queue.empty()) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            cv.notify_all();
+            const ParseResult res = isPack ? pack.load(job.index, objs) : decoder.decode(job.data, objs);
+            std::ostringstream line;
+            line << job.index << " " << job.name << ": ";
+            if (res.error != ParseError::NONE) {
+                ++failed;
+                line << parseErrorName(res.error) << "\n";
+            } else {
+                ++decoded;
+                objects += (long long)objs.size();
+                line << objs.size() << " objects";
+                if (solve) {
+                    std::string err;
+                    const std::string stem = std::to_string(job.index);
+                    if (!saveBinaryLevel(outDir / (stem + ".pfl"), objs, err)) { ++failedWrites; line << ", " << err; }
+                    float goalX = 0.0f;
+                    SimState start = levelStart(objs, goalX);
+                    AnytimeResult r = AnytimeSolver::start(objs, start, goalX, ANYTIME_BUDGET, nullptr)->waitFinished();
+                    const std::filesystem::path macroPath = outDir / (stem + "_macro.txt");
+                    std::ofstream mf(macroPath.string(), std::ios::trunc);
+                    writeMacro(mf, r.holds);
+                    mf.close();
+                    solved += r.complete;
+                    line << ", " << (r.complete ? "solved" : "partial") << " by " << r.stage << ", " << r.jumps.size() << " jumps";
+                    if (!mf) { ++failedWrites; line << ", cannot write " << macroPath.string(); }
+                }
+                line << "\n";
+            }
+            std::lock_guard<std::mutex> lock(m);
+            std::cout << line.str();
+        }
+    };
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t<nThreads; ++t) pool.emplace_back(worker);
+    int count = 0;
+    auto enqueue = [&](std::string name, std::string data) {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [&] { return queue.size() < IMPORT_QUEUE * nThreads; });
+        queue.push_back({count++, std::move(name), std::move(data)});
+        cv.notify_all();
+    };
+    bool ok = true;
+    if (isPack) {
+        for (int i=0; i<pack.size(); ++i) enqueue(std::string(pack.name(i)), {});
+    } else {
+        ok = readSaveLevels(savePath, enqueue, err);
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        done = true;
+    }
+    cv.notify_all();
+    for (auto& th : pool) th.join();
+    const double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    if (!ok) std::cerr << savePath.string() << ": " << err << "\n";
+    std::cout << count << " levels, " << decoded << " decoded (" << objects << " objects), " << failed << " undecodable";
+    if (solve) std::cout << ", " << solved << " solved, " << failedWrites << " failed writes";
+    std::cout << ", " << std::fixed << std::setprecision(1) << ms << " ms on " << nThreads << " threads\n";
+    return ok && failedWrites == 0 ? 0 : 1;
+}
+
+// pathfinder-cli batch: solve every level file and level pack given, and every .txt, .pfl,
+// .gd or .pfk file in the directories given, writing <out dir>/<level>/macro.txt and
+// pathfinder_report.txt; a pack's levels are named by their entries.
+// All file traffic goes through a FileIO, so solver threads never wait on the disk.
+static int cliBatch(int argc, char** argv) {
+    bool allowRing = true;
+    if (argc > 0 && std::string(argv[0]) == "--pool-io") { allowRing = false; ++argv; --argc; }
+    int nThreads = (int)std::max(1u, std::thread::hardware_concurrency());
+    if (argc > 1 && std::string(argv[0]) == "--threads") { nThreads = std::max(1, std::atoi(argv[1])); argv += 2; argc -= 2; }
+    if (argc < 2) {
+        std::cerr << "batch needs an out dir and level files or directories\n";
+        return 64;
+    }
+    const std::filesystem::path outDir = argv[0];
+    std::vector<std::filesystem::path> files;
+    for (int i=1; i<argc; ++i) {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(argv[i], ec)) {
+            files.push_back(argv[i]);
+            continue;
+        }
+        std::vector<std::filesystem::path> dir;
+        for (const auto& e : std::filesystem::directory_iterator(argv[i], ec)) {
+            const std::string ext = e.path().extension().string();
+            if (e.is_regular_file() && (ext == ".txt" || ext == ".pfl" || ext == ".gd" || ext == ".pfk")) dir.push_back(e.path());
+        }
+        std::sort(dir.begin(), dir.end());
+        files.insert(files.end(), dir.begin(), dir.end());
+    }
+    // Levels in order: a level file, or an entry of a pack, which is read from the pack's
+    // mapping instead of through the FileIO.
+    struct Level { std::string label, name; const LevelPack* pack; int entry; std::filesystem::path file; };
+    std::vector<std::unique_ptr<LevelPack>> packs;
+    std::vector<Level> levels;
+    for (const std::filesystem::path& f : files) {
+        if (!LevelPack::isPack(f)) {
+            levels.push_back({f.string(), f.stem().string(), nullptr, -1, f});
+            continue;
+        }
+        packs.emplace_back(new LevelPack());
+        std::string err;
+        if (!packs.back()->open(f, err)) {
+            std::cerr << f.string() << ": " << err << "\n";
+            return 1;
+        }
+        for (int e=0; e<packs.back()->size(); ++e) {
+            const std::string name(packs.back()->name(e));
+            levels.push_back({f.string() + ":" + name, name, packs.back().get(), e, {}});
+        }
+    }
+    // one out dir per level, named after the file or pack entry; repeated names get the level's number
+    std::vector<std::filesystem::path> levelDirs;
+    std::set<std::string> used;
+    for (size_t i=0; i<levels.size(); ++i) {
+        std::string name = levels[i].name;
+        if (!used.insert(name).second) name += "_" + std::to_string(i);
+        levelDirs.push_back(outDir / name);
+        std::error_code ec;
+        std::filesystem::create_directories(levelDirs.back(), ec);
+        if (ec) {
+            std::cerr << levelDirs.back().string() << ": " << ec.message() << "\n";
+            return 1;
+        }
+    }
+
+    FileIO io;
+    io.start(allowRing);
+    struct Job { size_t index; std::string bytes; bool ok; };
+    std::deque<Job> queue;
+    size_t waiting = 0;   // reads issued and not yet taken by a worker
+    bool done = false;
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<int> solved{0}, unreadable{0};
+    auto worker = [&]() {
+        std::vector<Obj> objs;
+        for (;;) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                cv.wait(lock, [&] { return !queue.empty() || (done && waiting == 0); });
+                if (queue.empty()) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+                --waiting;
+            }
+            cv.notify_all();
+            const Level& level = levels[job.index];
+            std::ostringstream line;
+            line << level.label << ": ";
+            if (!job.ok) {
+                ++unreadable;
+                line << "cannot read\n";
+                std::lock_guard<std::mutex> lock(m);
+                std::cout << line.str();
+                continue;
+            }
+            const ParseResult res = level.pack ? level.pack->load(level.entry, objs) : parseLevelBytes(job.bytes, objs);
+            job.bytes = std::string();
+            std::ostringstream rep, macro;
+            rep << "parse debug:\n" << parseDebug(res) << "\n";
+            if (res.error != ParseError::NONE) {
+                line << parseErrorName(res.error) << "\n";
+            } else {
+                float goalX = 0.0f;
+                SimState start = levelStart(objs, goalX);
+                AnytimeResult r = AnytimeSolver::start(objs, start, goalX, ANYTIME_BUDGET, nullptr)->waitFinished();
+                rep << r.report;
+                if (jumpsFromHolds(objs, start, goalX, r.holds) != r.jumps) rep << "warning: presses do not replay to the planned jumps\n";
+                writeMacro(macro, r.holds);
+                io.write(levelDirs[job.index] / "macro.txt", macro.str());
+                solved += r.complete;
+                line << (r.complete ? "solved" : "partial") << " by " << r.stage << ", " << r.jumps.size() << " jumps\n";
+            }
+            io.write(levelDirs[job.index] / "pathfinder_report.txt", rep.str());
+            std::lock_guard<std::mutex> lock(m);
+            std::cout << line.str();
+        }
+    };
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    std::vector<std::thread> pool;
+    for (int t=0; t<nThreads; ++t) pool.emplace_back(worker);
+    for (size_t i=0; i<levels.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&] { return waiting < IMPORT_QUEUE * nThreads; });
+            ++waiting;
+            if (levels[i].pack) {
+                queue.push_back({i, {}, true});
+                cv.notify_all();
+                continue;
+            }
+        }
+        io.read(levels[i].file, [&, i](std::string data, bool ok) {
+            std::lock_guard<std::mutex> lock(m);
+            queue.push_back({i, std::move(data), ok});
+            cv.notify_all();
+        });
+    }
+    {
+        std::lock_guard<std::mutex> lock(m);
+        done = true;
+    }
+    cv.notify_all();
+    for (auto& th : pool) th.join();
+    io.finish();
+    const double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    std::cout << levels.size() << " levels, " << solved << " solved, " << unreadable << " unreadable, " << io.failedWrites()
+              << " failed writes, " << std::fixed << std::setprecision(1) << ms << " ms on " << nThreads << " threads with "
+              << io.backend() << " I/O\n";
+    return unreadable == 0 && io.failedWrites() == 0 ? 0 : 1;
+}
+
+// pathfinder-cli stream: solve a level a window at a time, writing macro.txt as it goes.
+static int cliStream(const std::filesystem::path& levelPath, const std::filesystem::path& outDir) {
+    using clock = std::chrono::steady_clock;
+    const auto t0 = clock::now();
+    LevelStream level;
+    std::string err;
+    if (!level.open(levelPath, err)) {
+        std::cerr << levelPath.string() << ": " << err << "\n";
+        return 1;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(outDir, ec);
+    std::ofstream mf((outDir / "macro.txt").string(), std::ios::trunc);
+    if (ec || !mf) {
+        std::cerr << "cannot write " << (outDir / "macro.txt").string() << "\n";
+        return 1;
+    }
+    std::string report;
+    const bool ok = runStreaming(level, mf, report);
+    std::ofstream((outDir / "pathfinder_report.txt").string(), std::ios::trunc) << report;
+    const double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+    std::cout << levelPath.string() << ": " << (ok ? "solved" : "failed") << " in " << std::fixed << std::setprecision(1) << ms << " ms\n" << report;
+    return ok ? 0 : 2;
+}
+
+// pathfinder-cli pack: write many levels into one level pack.
+static int cliPack(const std::filesystem::path& out, int count, char** paths) {
+    std::vector<std::string> list(paths, paths + count);
+    std::string err;
+    if (!LevelPack::write(out, list, err)) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+    uintmax_t in = 0;
+    for (const std::string& p : list) in += std::filesystem::file_size(p);
+    const uintmax_t size = std::filesystem::file_size(out);
+    std::cout << out.string() << ": " << count << " levels, " << size << " bytes (" << in << " bytes of level files, "
+              << std::fixed << std::setprecision(1) << (double)in / std::max<uintmax_t>(1, size) << "x smaller)\n";
+    return 0;
+}
+
+// pathfinder-cli convert: write any readable level as a binary level.
+static int cliConvert(const std::filesystem::path& in, const std::filesystem::path& out) {
+    std::vector<Obj> objs;
+    std::string dbg, err;
+    if (!parseLevelFile(in, objs, dbg)) {
+        std::cerr << in.string() << ": " << dbg << "\n";
+        return 1;
+    }
+    if (!saveBinaryLevel(out, objs, err)) {
+        std::cerr << err << "\n";
+        return 1;
+    }
+    std::cout << out.string() << ": " << objs.size() << " objects\n";
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && std::string(argv[1]) == "--patterns") {
+        std::string err;
+        if (!PatternLibrary::get().load(argv[2], err)) {
+            std::cerr << err << "\n";
+            return 1;
+        }
+        argc -= 2;
+        argv += 2;
+    }
+    std::string cmd = argc > 1 ? argv[1] : "";
+    if (cmd == "solve" && argc >= 3) return cliSolve(argv[2], argc >= 4 ? argv[3] : ".");
+    if (cmd == "bench" && argc >= 3) return cliBench(argc - 2, argv + 2);
+    if (cmd == "train" && argc >= 4) return cliTrain(argv[2], argc - 3, argv + 3);
+    if (cmd == "check") return cliCheck(argc - 2, argv + 2);
+    if (cmd == "parse" && argc >= 3) return cliParse(argc - 2, argv + 2);
+    if (cmd == "convert" && argc >= 4) return cliConvert(argv[2], argv[3]);
+    if (cmd == "import" && argc >= 3) return cliImport(argc - 2, argv + 2);
+    if (cmd == "pack" && argc >= 4) return cliPack(argv[2], argc - 3, argv + 3);
+    if (cmd == "stream" && argc >= 3) return cliStream(argv[2], argc >= 4 ? argv[3] : ".");
+    if (cmd == "batch" && argc >= 3) return cliBatch(argc - 2, argv + 2);
+    std::cerr << "usage: pathfinder-cli [--patterns <library.pfp>] solve <level.txt> [out dir]\n"
+                 "       pathfinder-cli [--patterns <library.pfp>] bench <level.txt>...\n"
+                 "       pathfinder-cli train <library.pfp> <level.txt>...\n"
+                 "       pathfinder-cli check [level.txt...]\n"
+                 "       pathfinder-cli parse <level.txt>...\n"
+                 "       pathfinder-cli convert <level.txt> <level.pfl>\n"
+                 "       pathfinder-cli pack <levels.pfk> <level.txt>...\n"
+                 "       pathfinder-cli import [--no-solve] <CCLocalLevels.dat | levels.pfk> [out dir] [threads]\n"
+                 "       pathfinder-cli stream <level.pfl> [out dir]\n"
+                 "       pathfinder-cli batch [--pool-io] [--threads n] <out dir> <level, pack or dir>...\n";
+    return 64;
+}
+#endif